@@ -50,6 +50,7 @@ void AppConfig::LoadConfig()
 	if (!std::filesystem::exists(filePath)) return;
 	YAML::Node config = YAML::LoadFile(filePath);
 	copyOnWrite = config["CopyOnWrite"].as<bool>(copyOnWrite);
+	compressMessages = config["CompressMessages"].as<bool>(compressMessages);
 	filesToKeepInHistory = config["FilesToKeepInHistory"].as<uint32_t>(filesToKeepInHistory);
 	highlightedLineBackgroundColor = config["HighlightedLineBackgroundColor"].as<QColor>(highlightedLineBackgroundColor);
 }
@@ -63,6 +64,7 @@ void AppConfig::Save()
 
 	YAML::Node config;
 	config["CopyOnWrite"] = copyOnWrite;
+	config["CompressMessages"] = compressMessages;
 	config["FilesToKeepInHistory"] = filesToKeepInHistory;
 	config["HighlightedLineBackgroundColor"] = highlightedLineBackgroundColor;
 
@@ -167,6 +169,13 @@ void AppConfig::SetCopyOnWrite(bool enableCOW)
 	Save();
 }
 
+void AppConfig::SetMessageCompression(bool compress)
+{
+	if (compressMessages == compress) return;
+	compressMessages = compress;
+	Save();
+}
+
 int AppConfig::GetMaxLinesToCheckValue() const
 {
 	int max = 0;
@@ -55,6 +55,11 @@ public:
 
 	void SetCopyOnWrite(bool enableCOW);
 
+	// Newly opened logs keep their messages in compressed blocks
+	[[nodiscard]] bool UseMessageCompression() const { return compressMessages; }
+
+	void SetMessageCompression(bool compress);
+
 	[[nodiscard]] uint32_t GetFilesToKeepInHistory() const { return filesToKeepInHistory; }
 
 	void SetFilesToKeepInHistory(uint32_t count);
@@ -81,6 +86,8 @@ private:
 
 	bool copyOnWrite = false;
 
+	bool compressMessages = false;
+
 	TextViewConfig mainLogViewConfig, fullLogViewConfig;
 
 	uint32_t filesToKeepInHistory;
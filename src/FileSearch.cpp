@@ -0,0 +1,275 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "FileSearch.h"
+#include "SearchKernel.h"
+#include "Profiler.hpp"
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+void FileSearchResultModel::Reset(const QStringList& searchedFiles)
+{
+	beginResetModel();
+	files = searchedFiles;
+	hits.clear();
+	endResetModel();
+}
+
+void FileSearchResultModel::AppendHits(std::vector<FileSearchHit> batch)
+{
+	if (batch.empty()) return;
+	beginInsertRows(QModelIndex(), static_cast<int>(hits.size()), static_cast<int>(hits.size() + batch.size() - 1));
+	hits.insert(hits.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+	endInsertRows();
+}
+
+int FileSearchResultModel::rowCount(const QModelIndex& parent) const
+{
+	if (parent.isValid()) return 0;
+	return static_cast<int>(hits.size());
+}
+
+int FileSearchResultModel::columnCount(const QModelIndex& parent) const
+{
+	if (parent.isValid()) return 0;
+	return COLUMN_COUNT;
+}
+
+const FileSearchHit* FileSearchResultModel::GetHit(int row) const
+{
+	if (row < 0 || row >= static_cast<int>(hits.size())) return nullptr;
+	return &hits[row];
+}
+
+QVariant FileSearchResultModel::data(const QModelIndex& index, int role) const
+{
+	const FileSearchHit* hit = GetHit(index.row());
+	if (!hit) return {};
+
+	switch (role)
+	{
+	case Qt::DisplayRole:
+		switch (index.column())
+		{
+		case FILE: return QFileInfo(files[hit->file]).fileName();
+		case LINE: return QVariant::fromValue(hit->lineNumber);
+		case TEXT: return hit->line;
+		default: return {};
+		}
+	case Qt::ToolTipRole:
+		return files[hit->file];
+	default:
+		return {};
+	}
+}
+
+QVariant FileSearchResultModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal) return {};
+	switch (section)
+	{
+	case FILE: return tr("File");
+	case LINE: return tr("Line");
+	case TEXT: return tr("Text");
+	default: return {};
+	}
+}
+
+FileSearch::FileSearch(FileSearchResultModel* resultModel, QObject* parent)
+	: QObject(parent), resultModel(resultModel)
+{}
+
+FileSearch::~FileSearch()
+{
+	Cancel();
+	runningTask.waitForFinished();
+}
+
+void FileSearch::Cancel()
+{
+	if (currentCancelled)
+	{
+		*currentCancelled = true;
+		currentCancelled.reset();
+	}
+	currentGeneration++;
+	searching = false;
+}
+
+void FileSearch::Search(const QString& path, const QString& nameFilters, bool recursive, const QString& query, bool regex, bool matchCase)
+{
+	Cancel();
+	resultModel->Reset();
+	if (path.isEmpty() || query.isEmpty()) return;
+
+	SearchPattern pattern(query, regex, matchCase);
+	if (!pattern.IsValid())
+	{
+		emit SearchFailed(pattern.GetErrorString());
+		return;
+	}
+
+	QByteArray prefilter = pattern.GetIndexLiteral().toUtf8();
+	// The kernel only folds ASCII, other case insensitive literals are left to the pattern
+	if (!matchCase && std::any_of(prefilter.begin(), prefilter.end(), [](char c) { return static_cast<unsigned char>(c) >= 0x80; }))
+	{
+		prefilter.clear();
+	}
+
+	currentCancelled = std::make_shared<std::atomic_bool>(false);
+	searching = true;
+	SearchTask task { currentGeneration, path, nameFilters, recursive, pattern, prefilter, currentCancelled };
+	runningTask = QtConcurrent::run([this, task] { RunSearch(task); });
+}
+
+QStringList FileSearch::FindFiles(const SearchTask& task)
+{
+	QString directory = task.path;
+	QStringList filters = task.nameFilters.split(';', Qt::SkipEmptyParts);
+	for (QString& filter : filters) filter = filter.trimmed();
+
+	const QFileInfo pathInfo(task.path);
+	if (!pathInfo.isDir())
+	{ // A glob or a single file
+		directory = pathInfo.path();
+		filters = QStringList { pathInfo.fileName() };
+	}
+
+	QStringList files;
+	QDirIterator iterator(directory, filters, QDir::Files | QDir::Readable,
+						  task.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+	while (iterator.hasNext() && !*task.cancelled)
+	{
+		files.append(iterator.next());
+	}
+	files.sort();
+	return files;
+}
+
+void FileSearch::RunSearch(const SearchTask& task)
+{
+	BlockProfiler profiler(QString("Search in files (%1)").arg(SearchKernel::GetInstructionSet()));
+	const QStringList files = FindFiles(task);
+	if (*task.cancelled) return;
+	QMetaObject::invokeMethod(this, [this, generation = task.generation, files] {
+		if (generation != currentGeneration) return;
+		resultModel->Reset(files);
+		emit FilesFound(files);
+	}, Qt::QueuedConnection);
+
+	std::vector<uint32_t> fileIndices(files.size());
+	std::iota(fileIndices.begin(), fileIndices.end(), 0);
+	std::atomic<uint64_t> scannedBytes = 0;
+	QtConcurrent::blockingMap(fileIndices, [&](const uint32_t& file) {
+		if (*task.cancelled) return;
+		scannedBytes += ScanFile(task, file, files[file]);
+	});
+
+	if (*task.cancelled) return;
+	profiler.SetProcessedBytes(scannedBytes);
+	QMetaObject::invokeMethod(this, [this, generation = task.generation, fileCount = files.size(), bytes = scannedBytes.load()] {
+		if (generation != currentGeneration) return;
+		searching = false;
+		emit SearchFinished(fileCount, bytes);
+	}, Qt::QueuedConnection);
+}
+
+uint64_t FileSearch::ScanFile(const SearchTask& task, uint32_t file, const QString& path)
+{
+	QFile input(path);
+	if (!input.open(QIODevice::ReadOnly))
+	{
+		PostHits(task.generation, file, {}, 0, true);
+		return 0;
+	}
+
+	const size_t length = static_cast<size_t>(input.size());
+	const char* data = nullptr;
+	QByteArray fallback;
+	uchar* mapped = length > 0 ? input.map(0, static_cast<qint64>(length)) : nullptr;
+	if (mapped)
+	{
+		data = reinterpret_cast<const char*>(mapped);
+	}
+	else if (length > 0)
+	{ // Mapping is not supported by every file system
+		fallback = input.readAll();
+		data = fallback.constData();
+	}
+
+	const bool ignoreAsciiCase = !task.pattern.IsMatchCase();
+	std::vector<FileSearchHit> batch;
+	size_t hitCount = 0, position = 0, countedUpTo = 0;
+	uint64_t lineNumber = 1;
+	QElapsedTimer batchTimer;
+	batchTimer.start();
+
+	// Position is always at the start of a line
+	while (data && position < length && !*task.cancelled)
+	{
+		size_t lineStart = position, searchFrom = position;
+		if (!task.prefilter.isEmpty())
+		{
+			const ptrdiff_t found = SearchKernel::Find(data + position, length - position, task.prefilter.constData(), task.prefilter.size(), ignoreAsciiCase);
+			if (found < 0) break;
+			searchFrom = position + found;
+			lineStart = searchFrom;
+			while (lineStart > position && data[lineStart - 1] != '\n') lineStart--;
+		}
+		const char* newLine = static_cast<const char*>(std::memchr(data + searchFrom, '\n', length - searchFrom));
+		const size_t lineEnd = newLine ? newLine - data : length;
+		size_t textEnd = lineEnd;
+		if (textEnd > lineStart && data[textEnd - 1] == '\r') textEnd--;
+
+		lineNumber += std::count(data + countedUpTo, data + lineStart, '\n');
+		countedUpTo = lineStart;
+		position = lineEnd + 1;
+
+		const QString line = QString::fromUtf8(data + lineStart, static_cast<qsizetype>(textEnd - lineStart));
+		qsizetype start, matchLength;
+		if (!task.pattern.FindFirst(line, start, matchLength)) continue;
+		if (hitCount++ < MAX_LISTED_HITS_PER_FILE)
+		{
+			batch.push_back({ file, lineNumber, line, static_cast<int>(start), static_cast<int>(matchLength) });
+		}
+		if (batchTimer.elapsed() >= BATCH_INTERVAL_MS)
+		{
+			PostHits(task.generation, file, std::move(batch), hitCount, false);
+			batch = {};
+			batchTimer.restart();
+		}
+	}
+
+	if (mapped) input.unmap(mapped);
+	if (!*task.cancelled) PostHits(task.generation, file, std::move(batch), hitCount, true);
+	return length;
+}
+
+void FileSearch::PostHits(uint64_t generation, uint32_t file, std::vector<FileSearchHit> hits, size_t hitCount, bool finished)
+{
+	QMetaObject::invokeMethod(this, [this, generation, file, hits = std::move(hits), hitCount, finished] {
+		if (generation != currentGeneration) return;
+		resultModel->AppendHits(hits);
+		emit FileHitCountChanged(file, hitCount, finished);
+	}, Qt::QueuedConnection);
+}
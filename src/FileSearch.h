@@ -0,0 +1,136 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QFuture>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "SearchPattern.h"
+
+struct FileSearchHit
+{
+	uint32_t file;
+	uint64_t lineNumber;
+	QString line;
+	int start, length;
+};
+
+/**
+ * The matching lines of all files in the order they were found, batches of files searched in parallel interleave.
+ */
+class FileSearchResultModel final : public QAbstractTableModel
+{
+	Q_OBJECT
+
+	QStringList files;
+	std::vector<FileSearchHit> hits;
+
+public:
+	enum Column { FILE, LINE, TEXT, COLUMN_COUNT };
+
+	explicit FileSearchResultModel(QObject* parent = nullptr) : QAbstractTableModel(parent) {}
+
+	~FileSearchResultModel() override = default;
+
+	void Reset(const QStringList& searchedFiles = {});
+
+	void AppendHits(std::vector<FileSearchHit> batch);
+
+	[[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+	[[nodiscard]] int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+	[[nodiscard]] QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+	[[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	[[nodiscard]] const FileSearchHit* GetHit(int row) const;
+
+	[[nodiscard]] const QString& GetFile(uint32_t file) const { return files[file]; }
+};
+
+/**
+ * Searches files without loading them into a log holder.
+ * The files get memory mapped and scanned in parallel on the global thread pool, lines are only decoded
+ * once the substring kernel found the required literal of the query in them.
+ */
+class FileSearch final : public QObject
+{
+	Q_OBJECT
+
+public:
+	FileSearch(FileSearchResultModel* resultModel, QObject* parent = nullptr);
+
+	~FileSearch() override;
+
+	/**
+	 * The path is either a directory, whose files get filtered by the semicolon separated name filters,
+	 * or a glob like /var/log/app*.log.
+	 */
+	void Search(const QString& path, const QString& nameFilters, bool recursive, const QString& query, bool regex, bool matchCase);
+
+	void Cancel();
+
+	[[nodiscard]] bool IsSearching() const { return searching; }
+
+signals:
+	void FilesFound(const QStringList& files);
+
+	void FileHitCountChanged(uint32_t file, size_t hitCount, bool finished);
+
+	void SearchFinished(size_t fileCount, uint64_t scannedBytes);
+
+	void SearchFailed(const QString& error);
+
+private:
+	static constexpr int BATCH_INTERVAL_MS = 100;
+	// Only the first lines of files with excessive hit counts get listed, the count is still exact
+	static constexpr size_t MAX_LISTED_HITS_PER_FILE = 10000;
+
+	struct SearchTask
+	{
+		uint64_t generation;
+		QString path, nameFilters;
+		bool recursive;
+		SearchPattern pattern;
+		// UTF-8 literal every matching line contains, empty if lines can't be prefiltered
+		QByteArray prefilter;
+		std::shared_ptr<std::atomic_bool> cancelled;
+	};
+
+	[[nodiscard]] static QStringList FindFiles(const SearchTask& task);
+
+	void RunSearch(const SearchTask& task);
+
+	// Returns the number of scanned bytes
+	uint64_t ScanFile(const SearchTask& task, uint32_t file, const QString& path);
+
+	void PostHits(uint64_t generation, uint32_t file, std::vector<FileSearchHit> hits, size_t hitCount, bool finished);
+
+	FileSearchResultModel* resultModel;
+	uint64_t currentGeneration = 0;
+	std::shared_ptr<std::atomic_bool> currentCancelled;
+	QFuture<void> runningTask;
+	bool searching = false;
+};
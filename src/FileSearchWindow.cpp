@@ -0,0 +1,138 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "FileSearchWindow.h"
+#include "FileSearch.h"
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QLocale>
+
+FileSearchWindow::FileSearchWindow(QWidget* parent)
+	: QMainWindow(parent), resultModel(new FileSearchResultModel(this)), search(new FileSearch(resultModel, this))
+{
+	ui.setupUi(this);
+	ui.resultsView->setModel(resultModel);
+	ui.resultsView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	ui.resultsView->verticalHeader()->setDefaultSectionSize(ui.resultsView->fontMetrics().height() + 4);
+	ui.resultSplitter->setStretchFactor(1, 4);
+
+	connect(search, &FileSearch::FilesFound, this, &FileSearchWindow::OnFilesFound);
+	connect(search, &FileSearch::FileHitCountChanged, this, &FileSearchWindow::OnFileHitCountChanged);
+	connect(search, &FileSearch::SearchFinished, this, &FileSearchWindow::OnSearchFinished);
+	connect(search, &FileSearch::SearchFailed, this, &FileSearchWindow::OnSearchFailed);
+	connect(ui.resultsView, &QTableView::activated, this, &FileSearchWindow::OnResultActivated);
+	connect(ui.resultsView, &QTableView::doubleClicked, this, &FileSearchWindow::OnResultActivated);
+}
+
+FileSearchWindow::~FileSearchWindow()
+{
+	delete search;
+}
+
+void FileSearchWindow::on_browseButton_clicked()
+{
+	const QString directory = QFileDialog::getExistingDirectory(this, tr("Search in Directory"), ui.pathLineEdit->text());
+	if (!directory.isEmpty()) ui.pathLineEdit->setText(directory);
+}
+
+void FileSearchWindow::on_searchButton_clicked()
+{
+	StartSearch();
+}
+
+void FileSearchWindow::on_searchLineEdit_returnPressed()
+{
+	StartSearch();
+}
+
+void FileSearchWindow::on_cancelButton_clicked()
+{
+	search->Cancel();
+	ui.cancelButton->setEnabled(false);
+	ui.statusLabel->setText(tr("Cancelled, %1").arg(ui.statusLabel->text()));
+}
+
+void FileSearchWindow::StartSearch()
+{
+	searchedFiles.clear();
+	fileRows.clear();
+	finishedFiles = totalHits = 0;
+	ui.filesTable->setRowCount(0);
+	ui.statusLabel->clear();
+	search->Search(ui.pathLineEdit->text(), ui.fileFilterLineEdit->text(), ui.recursiveCheckBox->isChecked(),
+				   ui.searchLineEdit->text(), ui.regexCheckBox->isChecked(), ui.matchCaseCheckBox->isChecked());
+	ui.cancelButton->setEnabled(search->IsSearching());
+	if (search->IsSearching()) ui.statusLabel->setText(tr("Looking for files..."));
+}
+
+void FileSearchWindow::OnFilesFound(const QStringList& files)
+{
+	searchedFiles = files;
+	fileRows.assign(files.size(), -1);
+	UpdateStatus();
+}
+
+void FileSearchWindow::OnFileHitCountChanged(uint32_t file, size_t hitCount, bool finished)
+{
+	if (file >= fileRows.size()) return;
+	if (finished) finishedFiles++;
+	if (hitCount > 0)
+	{
+		int& row = fileRows[file];
+		if (row < 0)
+		{
+			row = ui.filesTable->rowCount();
+			ui.filesTable->insertRow(row);
+			auto* nameItem = new QTableWidgetItem(QFileInfo(searchedFiles[file]).fileName());
+			nameItem->setToolTip(searchedFiles[file]);
+			ui.filesTable->setItem(row, 0, nameItem);
+			ui.filesTable->setItem(row, 1, new QTableWidgetItem());
+		}
+		QTableWidgetItem* countItem = ui.filesTable->item(row, 1);
+		totalHits += hitCount - countItem->data(Qt::UserRole).toULongLong();
+		countItem->setData(Qt::UserRole, QVariant::fromValue(static_cast<qulonglong>(hitCount)));
+		countItem->setText(finished ? QString::number(hitCount) : tr("%1 (searching)").arg(hitCount));
+	}
+	UpdateStatus();
+}
+
+void FileSearchWindow::OnSearchFinished(size_t fileCount, uint64_t scannedBytes)
+{
+	ui.cancelButton->setEnabled(false);
+	ui.statusLabel->setText(tr("%n hit(s) in %1 of %2 files, %3 scanned", "", static_cast<int>(totalHits))
+		.arg(ui.filesTable->rowCount()).arg(fileCount).arg(QLocale().formattedDataSize(static_cast<qint64>(scannedBytes))));
+}
+
+void FileSearchWindow::OnSearchFailed(const QString& error)
+{
+	ui.cancelButton->setEnabled(false);
+	ui.statusLabel->setText(tr("Invalid regex: %1").arg(error));
+}
+
+void FileSearchWindow::UpdateStatus()
+{
+	ui.statusLabel->setText(tr("%n hit(s), scanned %1 of %2 files...", "", static_cast<int>(totalHits))
+		.arg(finishedFiles).arg(searchedFiles.size()));
+}
+
+void FileSearchWindow::OnResultActivated(const QModelIndex& index)
+{
+	const FileSearchHit* hit = resultModel->GetHit(index.row());
+	if (!hit) return;
+	emit OpenFileRequested(resultModel->GetFile(hit->file), hit->lineNumber);
+}
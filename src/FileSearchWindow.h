@@ -0,0 +1,75 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QMainWindow>
+#include <vector>
+#include "ui_FileSearchWindow.h"
+
+class FileSearch;
+class FileSearchResultModel;
+
+class FileSearchWindow final : public QMainWindow
+{
+	Q_OBJECT
+
+public:
+	explicit FileSearchWindow(QWidget* parent = nullptr);
+
+	~FileSearchWindow() override;
+
+signals:
+	void OpenFileRequested(const QString& file, uint64_t lineNumber);
+
+private slots:
+	void on_browseButton_clicked();
+
+	void on_searchButton_clicked();
+
+	void on_searchLineEdit_returnPressed();
+
+	void on_cancelButton_clicked();
+
+	void OnFilesFound(const QStringList& files);
+
+	void OnFileHitCountChanged(uint32_t file, size_t hitCount, bool finished);
+
+	void OnSearchFinished(size_t fileCount, uint64_t scannedBytes);
+
+	void OnSearchFailed(const QString& error);
+
+	void OnResultActivated(const QModelIndex& index);
+
+private:
+	void StartSearch();
+
+	void UpdateStatus();
+
+	Ui::FileSearchWindowClass ui;
+
+	FileSearchResultModel* resultModel;
+
+	FileSearch* search;
+
+	QStringList searchedFiles;
+
+	// Row of every file in the files table, files only get a row once they have hits
+	std::vector<int> fileRows;
+
+	size_t finishedFiles = 0, totalHits = 0;
+};
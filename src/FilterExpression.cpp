@@ -0,0 +1,428 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "FilterExpression.h"
+#include <algorithm>
+
+QString FilterNode::ToKey() const
+{
+	const auto quote = [](QString value) { return '"' + value.replace('\\', "\\\\").replace('"', "\\\"") + '"'; };
+	const auto joinChildren = [this](const char* separator) {
+		QStringList keys;
+		for (const auto& child : children) keys.append(child->ToKey());
+		keys.sort();
+		return '(' + keys.join(QLatin1String(separator)) + ')';
+	};
+	const auto joinValues = [&](bool ignoreCase) {
+		QStringList quoted;
+		for (const QString& value : values) quoted.append(quote(ignoreCase ? value.toLower() : value));
+		quoted.sort();
+		quoted.removeDuplicates();
+		return '(' + quoted.join(',') + ')';
+	};
+
+	switch (type)
+	{
+	case ALL: return QStringLiteral("all");
+	case AND: return joinChildren(" and ");
+	case OR: return joinChildren(" or ");
+	case NOT: return "not " + children.front()->ToKey();
+	case LEVEL_IN: return "level in " + joinValues(true);
+	case TEMPLATE_IN: return "template in " + joinValues(false);
+	case TEXT_IN: return QString("c%1 in ").arg(static_cast<int>(component)) + joinValues(false);
+	case TIME_RANGE:
+	{
+		const auto bound = [this](bool has, const QDateTime& dateTime, int time) {
+			if (!has) return QString('*');
+			return timeOfDay ? QStringLiteral("T") + QString::number(time) : QString::number(dateTime.toMSecsSinceEpoch());
+		};
+		return "time [" + bound(hasFrom, from, fromTime) + ',' + bound(hasTo, to, toTime) + ')';
+	}
+	case PATTERN:
+		return QString("c%1 %2%3 ").arg(static_cast<int>(component)).arg(pattern.IsRegex() ? "~" : "contains").arg(pattern.IsMatchCase() ? "" : "i") + quote(pattern.GetPattern());
+	}
+	return {};
+}
+
+std::unique_ptr<FilterNode> FilterParser::Parse(const QString& expression, QString& error)
+{
+	FilterParser parser(expression);
+	parser.Tokenize();
+	std::unique_ptr<FilterNode> root;
+	if (parser.error.isEmpty())
+	{
+		if (parser.Peek().type == END)
+		{
+			root = std::make_unique<FilterNode>();
+		}
+		else
+		{
+			root = parser.ParseOr();
+			if (root && parser.Peek().type != END) root = parser.Fail(QObject::tr("Unexpected '%1'"), parser.Peek());
+		}
+	}
+	error = parser.error;
+	return root;
+}
+
+void FilterParser::Tokenize()
+{
+	const qsizetype length = expression.length();
+	qsizetype pos = 0;
+	while (pos < length)
+	{
+		const QChar c = expression[pos];
+		if (c.isSpace())
+		{
+			pos++;
+			continue;
+		}
+
+		Token token;
+		token.position = pos;
+		if (c == '"' || c == '\'')
+		{
+			token.type = STRING;
+			for (pos++; pos < length && expression[pos] != c; pos++)
+			{
+				if (expression[pos] == '\\' && pos + 1 < length) pos++;
+				token.text += expression[pos];
+			}
+			if (pos >= length)
+			{
+				error = QObject::tr("Unterminated string starting at %1").arg(token.position + 1);
+				return;
+			}
+			pos++;
+		}
+		else if (c == '(' || c == ')' || c == ',')
+		{
+			token.type = c == '(' ? LEFT_PARENTHESIS : c == ')' ? RIGHT_PARENTHESIS : COMMA;
+			token.text = c;
+			pos++;
+		}
+		else if (QStringLiteral("=!<>~&|").contains(c))
+		{
+			static const QStringList OPERATORS = { "==", "!=", "<=", ">=", "~*", "!~", "&&", "||", "=", "<", ">", "~", "!" };
+			token.type = OPERATOR;
+			for (const QString& op : OPERATORS)
+			{
+				if (QStringView(expression).sliced(pos).startsWith(op))
+				{
+					token.text = op;
+					break;
+				}
+			}
+			if (token.text.isEmpty())
+			{
+				error = QObject::tr("Unknown operator '%1' at %2").arg(c).arg(pos + 1);
+				return;
+			}
+			pos += token.text.length();
+		}
+		else
+		{
+			token.type = WORD;
+			while (pos < length && !expression[pos].isSpace() && !QStringLiteral("\"'(),=!<>~&|").contains(expression[pos]))
+			{
+				token.text += expression[pos++];
+			}
+		}
+		tokens.push_back(token);
+	}
+	Token end;
+	end.position = length;
+	tokens.push_back(end);
+}
+
+bool FilterParser::PeekKeyword(const char* keyword) const
+{
+	return Peek().type == WORD && Peek().text.compare(QLatin1String(keyword), Qt::CaseInsensitive) == 0;
+}
+
+std::unique_ptr<FilterNode> FilterParser::Fail(const QString& message, const Token& token)
+{
+	if (error.isEmpty())
+	{
+		const QString text = token.type == END ? QObject::tr("end of filter") : token.text;
+		error = message.arg(text) + QObject::tr(" at %1").arg(token.position + 1);
+	}
+	return nullptr;
+}
+
+std::unique_ptr<FilterNode> FilterParser::ParseOr()
+{
+	auto left = ParseAnd();
+	while (left && ((Peek().type == OPERATOR && Peek().text == "||") || PeekKeyword("or")))
+	{
+		Next();
+		auto right = ParseAnd();
+		if (!right) return nullptr;
+		auto node = std::make_unique<FilterNode>();
+		node->type = FilterNode::OR;
+		node->children.push_back(std::move(left));
+		node->children.push_back(std::move(right));
+		left = std::move(node);
+	}
+	return left;
+}
+
+std::unique_ptr<FilterNode> FilterParser::ParseAnd()
+{
+	auto left = ParseUnary();
+	while (left)
+	{
+		const Token& token = Peek();
+		if ((token.type == OPERATOR && token.text == "&&") || PeekKeyword("and"))
+		{
+			Next();
+		}
+		else if (token.type == END || token.type == RIGHT_PARENTHESIS || token.type == COMMA || PeekKeyword("or") ||
+				 (token.type == OPERATOR && token.text != "!"))
+		{
+			break;
+		} // Otherwise the next term is implicitly combined with and
+		auto right = ParseUnary();
+		if (!right) return nullptr;
+		auto node = std::make_unique<FilterNode>();
+		node->type = FilterNode::AND;
+		node->children.push_back(std::move(left));
+		node->children.push_back(std::move(right));
+		left = std::move(node);
+	}
+	return left;
+}
+
+std::unique_ptr<FilterNode> FilterParser::ParseUnary()
+{
+	if ((Peek().type == OPERATOR && Peek().text == "!") || PeekKeyword("not"))
+	{
+		Next();
+		auto child = ParseUnary();
+		return child ? Negate(std::move(child)) : nullptr;
+	}
+	return ParsePrimary();
+}
+
+std::unique_ptr<FilterNode> FilterParser::ParsePrimary()
+{
+	const Token& token = Next();
+	switch (token.type)
+	{
+	case LEFT_PARENTHESIS:
+	{
+		auto node = ParseOr();
+		if (!node) return nullptr;
+		if (Peek().type != RIGHT_PARENTHESIS) return Fail(QObject::tr("Expected ')' instead of '%1'"), Peek());
+		Next();
+		return node;
+	}
+	case STRING:
+		return MakePattern(LogComponent::MESSAGE, token.text, false, false);
+	case WORD:
+	{
+		LogComponent::Component component;
+		const Token& next = Peek();
+		const bool comparison = next.type == OPERATOR || (next.type == WORD && QStringList { "in", "contains", "icontains", "matches", "imatches" }.contains(next.text.toLower()));
+		if ((IsField(token.text, component) || token.text.compare("level", Qt::CaseInsensitive) == 0 || token.text.compare("template", Qt::CaseInsensitive) == 0) && comparison && next.text != "!" && next.text != "&&" && next.text != "||")
+		{
+			return ParseComparison(token);
+		}
+		return MakePattern(LogComponent::MESSAGE, token.text, false, false);
+	}
+	default:
+		return Fail(QObject::tr("Unexpected '%1'"), token);
+	}
+}
+
+std::unique_ptr<FilterNode> FilterParser::ParseComparison(const Token& field)
+{
+	const QString fieldName = field.text.toLower();
+	const Token& opToken = Next();
+	const QString op = opToken.text.toLower();
+	LogComponent::Component component = LogComponent::MESSAGE;
+	const bool isLevel = fieldName == "level", isTemplate = fieldName == "template";
+	if (!isLevel && !isTemplate) (void)IsField(fieldName, component);
+
+	if (fieldName == "time" && (op == "<" || op == "<=" || op == ">" || op == ">="))
+	{
+		return ParseTimeComparison(field, op);
+	}
+
+	if (op == "=" || op == "==" || op == "!=" || op == "in")
+	{
+		QStringList values;
+		if (op == "in")
+		{
+			if (!ParseValueList(values)) return nullptr;
+		}
+		else
+		{
+			const Token& value = Next();
+			if (value.type != WORD && value.type != STRING) return Fail(QObject::tr("Expected a value instead of '%1'"), value);
+			values.append(value.text);
+		}
+		if (isTemplate)
+		{
+			for (QString& id : values)
+			{
+				bool isNumber = false;
+				const uint32_t number = id.toUInt(&isNumber);
+				if (!isNumber) return Fail(QObject::tr("Template ids are numbers, not '%1'"), { WORD, id, opToken.position });
+				id = QString::number(number);
+			}
+		}
+		auto node = std::make_unique<FilterNode>();
+		node->type = isLevel ? FilterNode::LEVEL_IN : isTemplate ? FilterNode::TEMPLATE_IN : FilterNode::TEXT_IN;
+		node->component = component;
+		node->values = values;
+		return op == "!=" ? Negate(std::move(node)) : std::move(node);
+	}
+
+	if (isLevel) return Fail(QObject::tr("Levels can only be compared with =, != and in, not '%1'"), opToken);
+	if (isTemplate) return Fail(QObject::tr("Templates can only be compared with =, != and in, not '%1'"), opToken);
+
+	const Token& value = Next();
+	if (value.type != WORD && value.type != STRING) return Fail(QObject::tr("Expected a value instead of '%1'"), value);
+	if (op == "contains") return MakePattern(component, value.text, false, true);
+	if (op == "icontains") return MakePattern(component, value.text, false, false);
+	if (op == "~" || op == "matches" || op == "!~") {
+		auto node = MakePattern(component, value.text, true, true);
+		if (!node) return Fail(QObject::tr("Invalid regex '%1'"), value);
+		return op == "!~" ? Negate(std::move(node)) : std::move(node);
+	}
+	if (op == "~*" || op == "imatches")
+	{
+		auto node = MakePattern(component, value.text, true, false);
+		if (!node) return Fail(QObject::tr("Invalid regex '%1'"), value);
+		return node;
+	}
+	return Fail(QObject::tr("Unsupported operator '%1'"), opToken);
+}
+
+std::unique_ptr<FilterNode> FilterParser::ParseTimeComparison(const Token& field, const QString& op)
+{
+	const Token& value = Next();
+	if (value.type != WORD && value.type != STRING) return Fail(QObject::tr("Expected a time instead of '%1'"), value);
+
+	auto node = std::make_unique<FilterNode>();
+	node->type = FilterNode::TIME_RANGE;
+	QDateTime dateTime;
+	QTime time;
+	if (!ParseTime(value.text, dateTime, time, node->timeOfDay))
+	{
+		return Fail(QObject::tr("Invalid time '%1', expected yyyy-MM-dd HH:mm:ss.zzz or HH:mm:ss.zzz"), value);
+	}
+
+	// Timestamps have millisecond precision, so inclusive and exclusive bounds only differ by one
+	const int offset = (op == ">" || op == "<=") ? 1 : 0;
+	if (op[0] == '>')
+	{
+		node->hasFrom = true;
+		node->from = dateTime.addMSecs(offset);
+		node->fromTime = time.msecsSinceStartOfDay() + offset;
+	}
+	else
+	{
+		node->hasTo = true;
+		node->to = dateTime.addMSecs(offset);
+		node->toTime = time.msecsSinceStartOfDay() + offset;
+	}
+	return node;
+}
+
+bool FilterParser::ParseTime(const QString& text, QDateTime& dateTime, QTime& time, bool& timeOfDay)
+{
+	dateTime = QDateTime::fromString(text, Qt::ISODateWithMs);
+	for (const char* format : { "yyyy-MM-dd HH:mm:ss.zzz", "yyyy-MM-dd HH:mm:ss", "yyyy-MM-dd HH:mm", "yyyy-MM-dd" })
+	{
+		if (dateTime.isValid()) break;
+		dateTime = QDateTime::fromString(text, format);
+	}
+	timeOfDay = !dateTime.isValid();
+	if (!timeOfDay) return true;
+	for (const char* format : { "HH:mm:ss.zzz", "HH:mm:ss", "HH:mm" })
+	{
+		time = QTime::fromString(text, format);
+		if (time.isValid()) return true;
+	}
+	return false;
+}
+
+bool FilterParser::ParseValueList(QStringList& values)
+{
+	if (Peek().type != LEFT_PARENTHESIS)
+	{
+		Fail(QObject::tr("Expected '(' instead of '%1'"), Peek());
+		return false;
+	}
+	Next();
+	while (true)
+	{
+		const Token& value = Next();
+		if (value.type != WORD && value.type != STRING)
+		{
+			Fail(QObject::tr("Expected a value instead of '%1'"), value);
+			return false;
+		}
+		values.append(value.text);
+		const Token& separator = Next();
+		if (separator.type == RIGHT_PARENTHESIS) return true;
+		if (separator.type != COMMA)
+		{
+			Fail(QObject::tr("Expected ',' or ')' instead of '%1'"), separator);
+			return false;
+		}
+	}
+}
+
+bool FilterParser::IsField(const QString& word, LogComponent::Component& component)
+{
+	static const std::pair<const char*, LogComponent::Component> FIELDS[] = {
+		{ "message", LogComponent::MESSAGE }, { "thread", LogComponent::THREAD }, { "subsys", LogComponent::SUB_SYS },
+		{ "where", LogComponent::WHERE }, { "line", LogComponent::ORIGINAL_MESSAGE }, { "date", LogComponent::DATE },
+		{ "time", LogComponent::TIME }
+	};
+	for (const auto& [name, fieldComponent] : FIELDS)
+	{
+		if (word.compare(QLatin1String(name), Qt::CaseInsensitive) == 0)
+		{
+			component = fieldComponent;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::unique_ptr<FilterNode> FilterParser::MakePattern(LogComponent::Component component, const QString& text, bool regex, bool matchCase)
+{
+	auto node = std::make_unique<FilterNode>();
+	node->type = FilterNode::PATTERN;
+	node->component = component;
+	node->pattern = SearchPattern(text, regex, matchCase);
+	if (!node->pattern.IsValid()) return nullptr;
+	return node;
+}
+
+std::unique_ptr<FilterNode> FilterParser::Negate(std::unique_ptr<FilterNode> node)
+{
+	if (node->type == FilterNode::NOT) return std::move(node->children.front());
+	auto negation = std::make_unique<FilterNode>();
+	negation->type = FilterNode::NOT;
+	negation->children.push_back(std::move(node));
+	return negation;
+}
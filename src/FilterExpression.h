@@ -0,0 +1,132 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+#include "LogEntry.h"
+#include "SearchPattern.h"
+
+/**
+ * Node of a parsed filter expression. Negated comparisons are represented with a NOT node.
+ */
+struct FilterNode
+{
+	enum Type
+	{
+		ALL,         // Matches every entry, result of an empty expression
+		AND,
+		OR,
+		NOT,
+		LEVEL_IN,    // The level name is one of the values, case insensitive
+		TEMPLATE_IN, // The id of the message template is one of the values
+		TEXT_IN,     // The component equals one of the values
+		TIME_RANGE,  // from <= timestamp < to, either bound is optional
+		PATTERN      // Substring or regex on a component
+	};
+
+	Type type = ALL;
+	std::vector<std::unique_ptr<FilterNode>> children;
+	LogComponent::Component component = LogComponent::MESSAGE;
+	QStringList values;
+	SearchPattern pattern;
+
+	// Bounds of a time range, a time of day without a date refers to the day the log starts
+	bool hasFrom = false, hasTo = false, timeOfDay = false;
+	QDateTime from, to;
+	// Milliseconds since midnight, so the end of the day is a valid exclusive bound
+	int fromTime = 0, toTime = 0;
+
+	// Normalised text of the node, equal for nodes that match the same entries by construction
+	[[nodiscard]] QString ToKey() const;
+};
+
+/**
+ * Recursive descent parser of the filter language:
+ *
+ *   level in (Error, Warning) and not thread = main
+ *   subsys = net || message ~ "time.?out"
+ *   time >= "2023-05-01 10:00" and time < 10:05 and "connection reset"
+ *
+ * Fields are level, thread, subsys, time, date, message, where, line (the original text) and template.
+ * Text comparisons are =, !=, in (...), contains, icontains, ~ / matches (regex) and ~* / imatches.
+ * Levels and template ids only support =, != and in (...).
+ * Time supports <, <=, > and >=. Bare words and strings search the message ignoring case,
+ * terms next to each other are combined with and.
+ */
+class FilterParser final
+{
+public:
+	// Returns null and sets the error if the expression is invalid
+	[[nodiscard]] static std::unique_ptr<FilterNode> Parse(const QString& expression, QString& error);
+
+	// Parses a date time (yyyy-MM-dd HH:mm:ss.zzz) or a time of day (HH:mm:ss.zzz), the way time comparisons accept them
+	[[nodiscard]] static bool ParseTime(const QString& text, QDateTime& dateTime, QTime& time, bool& timeOfDay);
+
+private:
+	enum TokenType { END, WORD, STRING, OPERATOR, LEFT_PARENTHESIS, RIGHT_PARENTHESIS, COMMA };
+
+	struct Token
+	{
+		TokenType type = END;
+		QString text;
+		qsizetype position = 0;
+	};
+
+	explicit FilterParser(const QString& expression) : expression(expression) {}
+
+	void Tokenize();
+
+	[[nodiscard]] const Token& Peek() const { return tokens[current]; }
+
+	const Token& Next() { return tokens[current < tokens.size() - 1 ? current++ : current]; }
+
+	[[nodiscard]] bool PeekKeyword(const char* keyword) const;
+
+	std::unique_ptr<FilterNode> Fail(const QString& message, const Token& token);
+
+	std::unique_ptr<FilterNode> ParseOr();
+
+	std::unique_ptr<FilterNode> ParseAnd();
+
+	std::unique_ptr<FilterNode> ParseUnary();
+
+	std::unique_ptr<FilterNode> ParsePrimary();
+
+	std::unique_ptr<FilterNode> ParseComparison(const Token& field);
+
+	std::unique_ptr<FilterNode> ParseTimeComparison(const Token& field, const QString& op);
+
+	bool ParseValueList(QStringList& values);
+
+	[[nodiscard]] static bool IsField(const QString& word, LogComponent::Component& component);
+
+	[[nodiscard]] static std::unique_ptr<FilterNode> MakePattern(LogComponent::Component component, const QString& text, bool regex, bool matchCase);
+
+	[[nodiscard]] static std::unique_ptr<FilterNode> Negate(std::unique_ptr<FilterNode> node);
+
+	const QString expression;
+	std::vector<Token> tokens;
+	size_t current = 0;
+	QString error;
+};
@@ -0,0 +1,559 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "FilterPlan.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+
+namespace
+{
+	constexpr uint32_t COLUMN_COST = 1, TEXT_EQUALS_COST = 10, SUBSTRING_COST = 20, REGEX_COST = 100;
+
+	template<typename T>
+	std::vector<uint8_t> MakeLookupTable(const std::vector<T>& names, const std::function<bool(const T&)>& accept)
+	{
+		std::vector<uint8_t> table(names.size(), 0);
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			table[i] = accept(names[i]) ? 1 : 0;
+		}
+		return table;
+	}
+
+	template<typename Id>
+	void SelectIds(const std::vector<uint32_t>& input, const Id* column, const std::vector<uint8_t>& ids, std::vector<uint32_t>& output)
+	{
+		const uint8_t* table = ids.data();
+		const size_t tableSize = ids.size();
+		for (const uint32_t i : input)
+		{
+			const Id id = column[i];
+			if (id < tableSize && table[id]) output.push_back(i);
+		}
+	}
+}
+
+FilterPlan::FilterPlan(const LogFilter& filter, const LogHolder& holder) : holder(holder)
+{
+	steps.emplace_back();
+	if (filter.GetRoot())
+	{
+		Compile(0, *filter.GetRoot());
+	}
+	else
+	{
+		steps.front().type = MATCH_NONE;
+	}
+	ExtractIndexedSteps();
+	ExtractTimeWindow();
+	MarkMatchingChunks();
+}
+
+FilterPlan::FilterPlan(const std::vector<const FilterNode*>& conjunction, const LogHolder& holder) : holder(holder)
+{
+	steps.emplace_back();
+	if (!conjunction.empty())
+	{
+		CompileOperands(0, FilterNode::AND, conjunction);
+	}
+	ExtractIndexedSteps();
+	ExtractTimeWindow();
+	MarkMatchingChunks();
+}
+
+void FilterPlan::Compile(uint32_t stepIndex, const FilterNode& node)
+{
+	Step step;
+	switch (node.type)
+	{
+	case FilterNode::ALL:
+		step.type = MATCH_ALL;
+		break;
+	case FilterNode::AND:
+	case FilterNode::OR:
+	case FilterNode::NOT:
+		CompileBoolean(stepIndex, node);
+		return;
+	case FilterNode::LEVEL_IN:
+		step.type = LEVEL;
+		step.ids = MakeLookupTable<std::shared_ptr<LogLevel>>(holder.GetUsedLogLevels(), [&node](const std::shared_ptr<LogLevel>& level) {
+			return node.values.contains(level->GetLevelName(), Qt::CaseInsensitive);
+		});
+		for (size_t id = 0; id < step.ids.size(); id++)
+		{
+			if (step.ids[id]) step.levelMask |= ZoneMap::GetLevelBit(static_cast<uint16_t>(id));
+		}
+		break;
+	case FilterNode::TEMPLATE_IN:
+		step.type = TEMPLATE;
+		step.ids.assign(holder.GetTemplateMiner().GetTemplateCount(), 0);
+		for (const QString& value : node.values)
+		{
+			const uint32_t id = value.toUInt();
+			if (id < step.ids.size()) step.ids[id] = 1;
+		}
+		break;
+	case FilterNode::TEXT_IN:
+		if (node.component == LogComponent::THREAD || node.component == LogComponent::SUB_SYS)
+		{
+			const bool thread = node.component == LogComponent::THREAD;
+			step.type = thread ? THREAD : SUB_SYS;
+			step.ids = MakeLookupTable<QString>(thread ? holder.GetThreadNames() : holder.GetSubSystemNames(),
+												[&node](const QString& name) { return node.values.contains(name); });
+		}
+		else
+		{
+			step.type = TEXT_EQUALS;
+			step.component = node.component;
+			step.values = node.values;
+			step.cost = TEXT_EQUALS_COST;
+		}
+		break;
+	case FilterNode::TIME_RANGE:
+		step.type = TIME_RANGE;
+		if (node.hasFrom) step.from = holder.ResolveTime(node.from, node.fromTime, node.timeOfDay);
+		if (node.hasTo) step.to = holder.ResolveTime(node.to, node.toTime, node.timeOfDay);
+		if (step.from >= step.to) step.type = MATCH_NONE;
+		break;
+	case FilterNode::PATTERN:
+		step.type = node.pattern.IsEmpty() ? MATCH_ALL : PATTERN;
+		step.component = node.component;
+		step.pattern = node.pattern;
+		step.cost = node.pattern.IsRegex() ? REGEX_COST : SUBSTRING_COST;
+		if (node.component == LogComponent::MESSAGE) step.trigrams = ZoneMap::GetTrigrams(node.pattern.GetRequiredLiterals());
+		break;
+	}
+
+	if (step.type == LEVEL || step.type == THREAD || step.type == SUB_SYS || step.type == TEMPLATE)
+	{ // Ids that don't occur in this log can't match
+		step.cost = COLUMN_COST;
+		if (std::find(step.ids.begin(), step.ids.end(), 1) == step.ids.end()) step.type = MATCH_NONE;
+	}
+	else if (step.type == TIME_RANGE)
+	{
+		step.cost = COLUMN_COST;
+	}
+	steps[stepIndex] = std::move(step);
+}
+
+void FilterPlan::CollectOperands(const FilterNode& node, FilterNode::Type type, std::vector<const FilterNode*>& operands)
+{
+	for (const auto& child : node.children)
+	{
+		if (child->type == type) CollectOperands(*child, type, operands);
+		else operands.push_back(child.get());
+	}
+}
+
+void FilterPlan::CompileBoolean(uint32_t stepIndex, const FilterNode& node)
+{
+	std::vector<const FilterNode*> operands;
+	if (node.type == FilterNode::NOT)
+	{
+		operands.push_back(node.children.front().get());
+	}
+	else
+	{
+		CollectOperands(node, node.type, operands);
+	}
+	CompileOperands(stepIndex, node.type, operands);
+}
+
+void FilterPlan::CompileOperands(uint32_t stepIndex, FilterNode::Type type, const std::vector<const FilterNode*>& operands)
+{
+	// Children are stored next to each other, their own children get appended behind them
+	const uint32_t first = static_cast<uint32_t>(steps.size());
+	steps.resize(first + operands.size());
+	for (uint32_t i = 0; i < operands.size(); i++)
+	{
+		Compile(first + i, *operands[i]);
+	}
+
+	Step step;
+	if (type == FilterNode::NOT)
+	{
+		const StepType childType = steps[first].type;
+		if (childType == MATCH_ALL || childType == MATCH_NONE)
+		{
+			step.type = childType == MATCH_ALL ? MATCH_NONE : MATCH_ALL;
+			steps.resize(first);
+		}
+		else
+		{
+			step.type = NOT;
+			step.firstChild = first;
+			step.childCount = 1;
+			step.cost = steps[first].cost;
+		}
+		steps[stepIndex] = std::move(step);
+		return;
+	}
+
+	// A neutral operand can be dropped, an absorbing one decides the result on its own
+	const bool isAnd = type == FilterNode::AND;
+	const StepType neutral = isAnd ? MATCH_ALL : MATCH_NONE, absorbing = isAnd ? MATCH_NONE : MATCH_ALL;
+	const auto begin = steps.begin() + first, end = begin + static_cast<ptrdiff_t>(operands.size());
+	if (std::any_of(begin, end, [absorbing](const Step& operand) { return operand.type == absorbing; }))
+	{
+		step.type = absorbing;
+		steps.resize(first);
+		steps[stepIndex] = std::move(step);
+		return;
+	}
+	const auto remainingEnd = std::stable_partition(begin, end, [neutral](const Step& operand) { return operand.type != neutral; });
+	const uint32_t remaining = static_cast<uint32_t>(remainingEnd - begin);
+	if (remaining == 0)
+	{
+		step.type = neutral;
+		steps.resize(first);
+		steps[stepIndex] = std::move(step);
+		return;
+	}
+
+	// Cheap operands first, so expensive ones only see what is left of the selection
+	std::stable_sort(begin, remainingEnd, [](const Step& a, const Step& b) { return a.cost < b.cost; });
+	if (remaining == 1)
+	{
+		steps[stepIndex] = std::move(steps[first]);
+		return;
+	}
+	step.type = isAnd ? AND : OR;
+	step.firstChild = first;
+	step.childCount = remaining;
+	step.cost = std::accumulate(begin, remainingEnd, 0u, [](uint32_t sum, const Step& operand) { return sum + operand.cost; });
+	steps[stepIndex] = std::move(step);
+}
+
+bool FilterPlan::IsIndexed(const Step& step) const
+{
+	switch (step.type)
+	{
+	case LEVEL:
+	case THREAD:
+	case SUB_SYS:
+		return true;
+	case AND:
+	case OR:
+	case NOT:
+		for (uint32_t i = 0; i < step.childCount; i++)
+		{
+			if (!IsIndexed(steps[step.firstChild + i])) return false;
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+RoaringBitmap FilterPlan::ToBitmap(const Step& step) const
+{
+	const auto unite = [&step](const std::vector<RoaringBitmap>& bitmaps) {
+		RoaringBitmap result;
+		for (size_t id = 0; id < step.ids.size() && id < bitmaps.size(); id++)
+		{
+			if (step.ids[id]) result = result.Or(bitmaps[id]);
+		}
+		return result;
+	};
+
+	switch (step.type)
+	{
+	case LEVEL: return unite(holder.GetLevelBitmaps());
+	case THREAD: return unite(holder.GetThreadBitmaps());
+	case SUB_SYS: return unite(holder.GetSubSystemBitmaps());
+	case NOT: return RoaringBitmap::Range(0, static_cast<uint32_t>(holder.GetEntries().size())).AndNot(ToBitmap(steps[step.firstChild]));
+	case AND:
+	case OR:
+	{
+		RoaringBitmap result = ToBitmap(steps[step.firstChild]);
+		for (uint32_t i = 1; i < step.childCount; i++)
+		{
+			result = step.type == AND ? result.And(ToBitmap(steps[step.firstChild + i])) : result.Or(ToBitmap(steps[step.firstChild + i]));
+		}
+		return result;
+	}
+	default:
+		return {};
+	}
+}
+
+void FilterPlan::ExtractIndexedSteps()
+{
+	Step& root = steps.front();
+	if (IsIndexed(root))
+	{
+		indexed = ToBitmap(root);
+		root = Step();
+		return;
+	}
+	if (root.type != AND) return;
+
+	// Operands of an and are independent, the indexed ones get moved to the front and replaced by the bitmap
+	const auto begin = steps.begin() + root.firstChild, end = begin + root.childCount;
+	const auto indexedEnd = std::stable_partition(begin, end, [this](const Step& operand) { return IsIndexed(operand); });
+	const uint32_t indexedCount = static_cast<uint32_t>(indexedEnd - begin);
+	if (indexedCount == 0) return;
+	RoaringBitmap bitmap = ToBitmap(*begin);
+	for (auto it = begin + 1; it != indexedEnd; ++it)
+	{
+		bitmap = bitmap.And(ToBitmap(*it));
+	}
+	indexed = std::move(bitmap);
+
+	if (root.childCount - indexedCount == 1)
+	{
+		root = *indexedEnd;
+	}
+	else
+	{
+		root.firstChild += indexedCount;
+		root.childCount -= indexedCount;
+	}
+}
+
+void FilterPlan::ExtractTimeWindow()
+{
+	if (!holder.IsTimeSorted()) return;
+	const auto narrow = [this](const Step& step) {
+		const auto [first, last] = holder.GetEntryRangeForTime(step.from, step.to);
+		windowBegin = std::max(windowBegin, first);
+		windowEnd = std::min(windowEnd, last);
+	};
+
+	Step& root = steps.front();
+	if (root.type == TIME_RANGE)
+	{
+		narrow(root);
+		root = Step();
+		return;
+	}
+	if (root.type != AND) return;
+
+	// In a log that is in time order the window matches exactly the entries of the range, the steps aren't needed anymore
+	const auto begin = steps.begin() + root.firstChild, end = begin + root.childCount;
+	for (auto it = begin; it != end; ++it)
+	{
+		if (it->type == TIME_RANGE) narrow(*it);
+	}
+	const auto remainingEnd = std::stable_partition(begin, end, [](const Step& operand) { return operand.type != TIME_RANGE; });
+	const uint32_t remaining = static_cast<uint32_t>(remainingEnd - begin);
+	if (remaining == 0) root = Step();
+	else if (remaining == 1) root = *begin;
+	else root.childCount = remaining;
+}
+
+void FilterPlan::MarkMatchingChunks()
+{
+	const ZoneMap& zoneMap = holder.GetZoneMap();
+	chunkMayMatch.resize(zoneMap.GetChunkCount());
+	for (size_t chunk = 0; chunk < chunkMayMatch.size(); chunk++)
+	{
+		chunkMayMatch[chunk] = MayMatch(steps.front(), chunk) ? 1 : 0;
+	}
+}
+
+bool FilterPlan::MayMatch(const Step& step, size_t chunk) const
+{
+	const ZoneMap& zoneMap = holder.GetZoneMap();
+	const auto begin = steps.begin() + step.firstChild, end = begin + step.childCount;
+	const auto childMayMatch = [this, chunk](const Step& child) { return MayMatch(child, chunk); };
+	switch (step.type)
+	{
+	case MATCH_NONE:
+		return false;
+	case AND:
+		return std::all_of(begin, end, childMayMatch);
+	case OR:
+		return std::any_of(begin, end, childMayMatch);
+	case LEVEL:
+		return zoneMap.MayContainLevels(chunk, step.levelMask);
+	case TIME_RANGE:
+		return zoneMap.MayContainTime(chunk, step.from, step.to);
+	case PATTERN:
+		return step.trigrams.empty() || zoneMap.MayContainTrigrams(chunk, step.trigrams);
+	default: // A negation or an equality check can match anywhere
+		return true;
+	}
+}
+
+void FilterPlan::Evaluate(uint32_t begin, uint32_t end, std::vector<uint32_t>& result) const
+{
+	if (MatchesNothing()) return;
+	begin = std::max(begin, windowBegin);
+	end = std::min(end, windowEnd);
+	for (uint32_t chunkStart = begin; chunkStart < end;)
+	{
+		const size_t chunk = chunkStart / ZoneMap::CHUNK_SIZE;
+		const uint32_t chunkEnd = static_cast<uint32_t>(std::min<uint64_t>(end, (chunk + 1) * uint64_t(ZoneMap::CHUNK_SIZE)));
+		if (ChunkMayMatch(chunk)) EvaluateRange(chunkStart, chunkEnd, result);
+		chunkStart = chunkEnd;
+	}
+}
+
+void FilterPlan::EvaluateRange(uint32_t begin, uint32_t end, std::vector<uint32_t>& result) const
+{
+	if (indexed)
+	{
+		std::vector<uint32_t> candidates;
+		indexed->Extract(begin, end, candidates);
+		EvaluateSelection(candidates, result);
+		return;
+	}
+	if (steps.front().type == MATCH_ALL)
+	{
+		const size_t offset = result.size();
+		result.resize(offset + (end - begin));
+		std::iota(result.begin() + static_cast<ptrdiff_t>(offset), result.end(), begin);
+		return;
+	}
+
+	std::vector<uint32_t> selection, matches;
+	selection.reserve(BLOCK_SIZE);
+	matches.reserve(BLOCK_SIZE);
+	MessageStore::Reader reader(holder.GetMessageStore());
+	for (uint32_t blockStart = begin; blockStart < end; blockStart += std::min(BLOCK_SIZE, end - blockStart))
+	{
+		selection.resize(std::min(BLOCK_SIZE, end - blockStart));
+		std::iota(selection.begin(), selection.end(), blockStart);
+		matches.clear();
+		EvaluateStep(steps.front(), selection, matches, reader);
+		result.insert(result.end(), matches.begin(), matches.end());
+	}
+}
+
+void FilterPlan::Evaluate(const std::vector<uint32_t>& candidates, std::vector<uint32_t>& result) const
+{
+	if (candidates.empty() || MatchesNothing()) return;
+	std::vector<uint32_t> selected;
+	selected.reserve(candidates.size());
+	const auto first = std::lower_bound(candidates.begin(), candidates.end(), windowBegin);
+	const auto last = std::lower_bound(first, candidates.end(), windowEnd);
+	std::copy_if(first, last, std::back_inserter(selected), [this](uint32_t index) {
+		return ChunkMayMatch(index / ZoneMap::CHUNK_SIZE) && (!indexed || indexed->Contains(index));
+	});
+	EvaluateSelection(selected, result);
+}
+
+void FilterPlan::EvaluateSelection(const std::vector<uint32_t>& candidates, std::vector<uint32_t>& result) const
+{
+	if (candidates.empty()) return;
+	if (steps.front().type == MATCH_ALL)
+	{
+		result.insert(result.end(), candidates.begin(), candidates.end());
+		return;
+	}
+
+	std::vector<uint32_t> selection, matches;
+	selection.reserve(BLOCK_SIZE);
+	matches.reserve(BLOCK_SIZE);
+	MessageStore::Reader reader(holder.GetMessageStore());
+	for (size_t blockStart = 0; blockStart < candidates.size(); blockStart += BLOCK_SIZE)
+	{
+		const auto first = candidates.begin() + static_cast<ptrdiff_t>(blockStart);
+		selection.assign(first, first + static_cast<ptrdiff_t>(std::min<size_t>(BLOCK_SIZE, candidates.size() - blockStart)));
+		matches.clear();
+		EvaluateStep(steps.front(), selection, matches, reader);
+		result.insert(result.end(), matches.begin(), matches.end());
+	}
+}
+
+void FilterPlan::EvaluateStep(const Step& step, const std::vector<uint32_t>& input, std::vector<uint32_t>& output, MessageStore::Reader& reader) const
+{
+	output.clear();
+	switch (step.type)
+	{
+	case MATCH_ALL:
+		output = input;
+		break;
+	case MATCH_NONE:
+		break;
+	case AND:
+	{
+		std::vector<uint32_t> current = input, next;
+		for (uint32_t i = 0; i < step.childCount && !current.empty(); i++)
+		{
+			EvaluateStep(steps[step.firstChild + i], current, next, reader);
+			current.swap(next);
+		}
+		output.swap(current);
+		break;
+	}
+	case OR:
+	{
+		// Entries that matched an operand are not tested against the remaining ones
+		std::vector<uint32_t> remaining = input, matched, buffer;
+		for (uint32_t i = 0; i < step.childCount && !remaining.empty(); i++)
+		{
+			EvaluateStep(steps[step.firstChild + i], remaining, matched, reader);
+			if (matched.empty()) continue;
+			buffer.clear();
+			std::merge(output.begin(), output.end(), matched.begin(), matched.end(), std::back_inserter(buffer));
+			output.swap(buffer);
+			buffer.clear();
+			std::set_difference(remaining.begin(), remaining.end(), matched.begin(), matched.end(), std::back_inserter(buffer));
+			remaining.swap(buffer);
+		}
+		break;
+	}
+	case NOT:
+	{
+		std::vector<uint32_t> matched;
+		EvaluateStep(steps[step.firstChild], input, matched, reader);
+		std::set_difference(input.begin(), input.end(), matched.begin(), matched.end(), std::back_inserter(output));
+		break;
+	}
+	case LEVEL:
+		SelectIds(input, holder.GetLevelColumn().data(), step.ids, output);
+		break;
+	case THREAD:
+		SelectIds(input, holder.GetThreadColumn().data(), step.ids, output);
+		break;
+	case SUB_SYS:
+		SelectIds(input, holder.GetSubSystemColumn().data(), step.ids, output);
+		break;
+	case TEMPLATE:
+		SelectIds(input, holder.GetTemplateColumn().data(), step.ids, output);
+		break;
+	case TEXT_EQUALS:
+	{
+		for (const uint32_t i : input)
+		{
+			if (step.values.contains(reader.GetComponent(i, step.component))) output.push_back(i);
+		}
+		break;
+	}
+	case TIME_RANGE:
+	{
+		const int64_t* timeStamps = holder.GetTimeStampColumn().data();
+		for (const uint32_t i : input)
+		{
+			if (timeStamps[i] >= step.from && timeStamps[i] < step.to) output.push_back(i);
+		}
+		break;
+	}
+	case PATTERN:
+	{
+		for (const uint32_t i : input)
+		{
+			if (step.pattern.Matches(reader.GetComponent(i, step.component))) output.push_back(i);
+		}
+		break;
+	}
+	}
+}
@@ -0,0 +1,122 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+#include "LogHolder.h"
+#include "LogFilter.h"
+
+/**
+ * A filter compiled against the columns of a log holder.
+ * The expression tree is flattened into an array of steps, names are resolved to the ids of the
+ * dictionary encoded columns and the operands of every and/or are ordered by their estimated cost.
+ * Evaluation works on blocks of entries: every step narrows down a selection vector of entry indices,
+ * so expensive text predicates only see the entries that survived the cheap column checks.
+ * Restrictions on the level, thread and sub system are answered up front by combining the bitmaps of the holder,
+ * only the entries in the resulting bitmap are visited at all.
+ * Chunks of the log whose zone map rules out a match, like a time range outside the requested one,
+ * are skipped as a whole.
+ * A time range the whole filter depends on is turned into a window of entry indices with a binary search,
+ * as long as the log is in time order.
+ */
+class FilterPlan final
+{
+public:
+	FilterPlan(const LogFilter& filter, const LogHolder& holder);
+
+	// Plan for the and of the given nodes, used to only test the restrictions a refined filter adds
+	FilterPlan(const std::vector<const FilterNode*>& conjunction, const LogHolder& holder);
+
+	// Appends the indices of all matching entries in [begin, end) in ascending order
+	void Evaluate(uint32_t begin, uint32_t end, std::vector<uint32_t>& result) const;
+
+	// Appends the matching indices out of the ascending candidate indices
+	void Evaluate(const std::vector<uint32_t>& candidates, std::vector<uint32_t>& result) const;
+
+	[[nodiscard]] bool MatchesAll() const { return !indexed && !HasTimeWindow() && steps.front().type == MATCH_ALL; }
+
+	[[nodiscard]] bool MatchesNothing() const
+	{
+		return steps.front().type == MATCH_NONE || (indexed && indexed->IsEmpty()) || windowBegin >= windowEnd;
+	}
+
+private:
+	static constexpr uint32_t BLOCK_SIZE = 4096;
+
+	enum StepType { MATCH_ALL, MATCH_NONE, AND, OR, NOT, LEVEL, THREAD, SUB_SYS, TEMPLATE, TEXT_EQUALS, TIME_RANGE, PATTERN };
+
+	struct Step
+	{
+		StepType type = MATCH_ALL;
+		// Children of and/or/not are stored next to each other
+		uint32_t firstChild = 0, childCount = 0;
+		uint32_t cost = 0;
+		// Lookup table of the accepted level, thread, sub system or template ids
+		std::vector<uint8_t> ids;
+		// Zone map representation of the step: levels as bit mask, literals of a message pattern as trigrams
+		uint64_t levelMask = 0;
+		std::vector<uint64_t> trigrams;
+		LogComponent::Component component = LogComponent::MESSAGE;
+		QStringList values;
+		int64_t from = INT64_MIN, to = INT64_MAX;
+		SearchPattern pattern;
+	};
+
+	void Compile(uint32_t stepIndex, const FilterNode& node);
+
+	// Compiles and/or/not, folding constant operands and ordering the remaining ones by cost
+	void CompileBoolean(uint32_t stepIndex, const FilterNode& node);
+
+	void CompileOperands(uint32_t stepIndex, FilterNode::Type type, const std::vector<const FilterNode*>& operands);
+
+	static void CollectOperands(const FilterNode& node, FilterNode::Type type, std::vector<const FilterNode*>& operands);
+
+	[[nodiscard]] bool IsIndexed(const Step& step) const;
+
+	[[nodiscard]] RoaringBitmap ToBitmap(const Step& step) const;
+
+	// Moves the indexed restrictions at the top of the plan into the bitmap
+	void ExtractIndexedSteps();
+
+	// Replaces the time ranges at the top of the plan with the window of entries having a matching timestamp
+	void ExtractTimeWindow();
+
+	[[nodiscard]] bool HasTimeWindow() const { return windowBegin != 0 || windowEnd != UINT32_MAX; }
+
+	void MarkMatchingChunks();
+
+	[[nodiscard]] bool MayMatch(const Step& step, size_t chunk) const;
+
+	[[nodiscard]] bool ChunkMayMatch(size_t chunk) const { return chunk >= chunkMayMatch.size() || chunkMayMatch[chunk]; }
+
+	void EvaluateRange(uint32_t begin, uint32_t end, std::vector<uint32_t>& result) const;
+
+	void EvaluateSelection(const std::vector<uint32_t>& candidates, std::vector<uint32_t>& result) const;
+
+	// All steps of an evaluation share the reader, so blocks of a compressed log are only decompressed again when going back
+	void EvaluateStep(const Step& step, const std::vector<uint32_t>& input, std::vector<uint32_t>& output, MessageStore::Reader& reader) const;
+
+	const LogHolder& holder;
+	std::vector<Step> steps;
+	// Entries matching the restrictions that got answered by the bitmaps, the steps only get evaluated for these
+	std::optional<RoaringBitmap> indexed;
+	// Only entries in [windowBegin, windowEnd) can match
+	uint32_t windowBegin = 0, windowEnd = UINT32_MAX;
+	std::vector<uint8_t> chunkMayMatch;
+};
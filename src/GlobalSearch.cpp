@@ -0,0 +1,250 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GlobalSearch.h"
+#include "Profiler.hpp"
+#include "SearchScan.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <tuple>
+
+void GlobalSearchResultModel::Reset(const std::vector<GlobalSearchSource>& searchSources)
+{
+	beginResetModel();
+	sources = searchSources;
+	hits.clear();
+	endResetModel();
+}
+
+void GlobalSearchResultModel::MergeHits(const std::vector<GlobalSearchHit>& batch)
+{
+	if (batch.empty()) return;
+	if (hits.empty() || !(batch.front() < hits.back()))
+	{ // Fast path, all the new hits are newer than the existing ones
+		beginInsertRows(QModelIndex(), static_cast<int>(hits.size()), static_cast<int>(hits.size() + batch.size() - 1));
+		hits.insert(hits.end(), batch.begin(), batch.end());
+		endInsertRows();
+		return;
+	}
+
+	// Runs of the batch that end up at the same position, as (position in hits, first in batch, count)
+	std::vector<std::tuple<size_t, size_t, size_t>> groups;
+	auto searchStart = hits.begin();
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		searchStart = std::upper_bound(searchStart, hits.end(), batch[i]);
+		const size_t position = searchStart - hits.begin();
+		if (!groups.empty() && std::get<0>(groups.back()) == position) std::get<2>(groups.back())++;
+		else groups.emplace_back(position, i, 1);
+	}
+
+	if (groups.size() > MAX_INSERT_GROUPS)
+	{
+		beginResetModel();
+		const size_t oldSize = hits.size();
+		hits.insert(hits.end(), batch.begin(), batch.end());
+		std::inplace_merge(hits.begin(), hits.begin() + oldSize, hits.end());
+		endResetModel();
+		return;
+	}
+
+	// Inserting back to front keeps the positions of the remaining groups valid
+	for (auto group = groups.rbegin(); group != groups.rend(); ++group)
+	{
+		const auto [position, first, count] = *group;
+		beginInsertRows(QModelIndex(), static_cast<int>(position), static_cast<int>(position + count - 1));
+		hits.insert(hits.begin() + position, batch.begin() + first, batch.begin() + first + count);
+		endInsertRows();
+	}
+}
+
+void GlobalSearchResultModel::RemoveSource(uint32_t source)
+{
+	if (source >= sources.size()) return;
+	beginResetModel();
+	sources[source].logHolder = nullptr;
+	hits.erase(std::remove_if(hits.begin(), hits.end(), [source](const GlobalSearchHit& hit) { return hit.source == source; }), hits.end());
+	endResetModel();
+}
+
+int GlobalSearchResultModel::rowCount(const QModelIndex& parent) const
+{
+	if (parent.isValid()) return 0;
+	return static_cast<int>(hits.size());
+}
+
+int GlobalSearchResultModel::columnCount(const QModelIndex& parent) const
+{
+	if (parent.isValid()) return 0;
+	return COLUMN_COUNT;
+}
+
+const GlobalSearchHit* GlobalSearchResultModel::GetHit(int row) const
+{
+	if (row < 0 || row >= static_cast<int>(hits.size())) return nullptr;
+	return &hits[row];
+}
+
+const LogEntry* GlobalSearchResultModel::GetEntry(const GlobalSearchHit& hit) const
+{
+	const LogHolder* holder = sources[hit.source].logHolder;
+	return holder ? &holder->GetEntries()[hit.entryIndex] : nullptr;
+}
+
+QVariant GlobalSearchResultModel::data(const QModelIndex& index, int role) const
+{
+	const GlobalSearchHit* hit = GetHit(index.row());
+	if (!hit) return {};
+	const LogEntry* entry = GetEntry(*hit);
+	if (!entry) return {};
+
+	switch (role)
+	{
+	case Qt::DisplayRole:
+		switch (index.column())
+		{
+		case SOURCE: return sources[hit->source].name;
+		case TIME: return entry->timeStamp.isValid() ? QDateTime::fromMSecsSinceEpoch(hit->timeStamp).toString("yyyy-MM-dd HH:mm:ss.zzz") : QString();
+		case MESSAGE: return sources[hit->source].logHolder->GetMessage(entry);
+		default: return {};
+		}
+	case Qt::ToolTipRole:
+		return tr("%1, line %2").arg(sources[hit->source].name).arg(entry->lineNumber);
+	default:
+		return {};
+	}
+}
+
+QVariant GlobalSearchResultModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal) return {};
+	switch (section)
+	{
+	case SOURCE: return tr("Tab");
+	case TIME: return tr("Time");
+	case MESSAGE: return tr("Message");
+	default: return {};
+	}
+}
+
+GlobalSearch::GlobalSearch(GlobalSearchResultModel* resultModel, QObject* parent)
+	: QObject(parent), resultModel(resultModel)
+{}
+
+GlobalSearch::~GlobalSearch()
+{
+	Cancel();
+	for (auto& source : sources)
+	{
+		source.task.waitForFinished();
+	}
+}
+
+void GlobalSearch::Cancel()
+{
+	for (auto& source : sources)
+	{
+		if (source.cancelled) *source.cancelled = true;
+	}
+	currentGeneration++;
+}
+
+bool GlobalSearch::IsSearching() const
+{
+	return std::any_of(sources.begin(), sources.end(), [](const SourceState& source) { return source.logHolder && !source.finished; });
+}
+
+void GlobalSearch::RemoveSource(uint32_t source)
+{
+	if (source >= sources.size()) return;
+	SourceState& state = sources[source];
+	if (state.cancelled) *state.cancelled = true;
+	state.task.waitForFinished();
+	state.logHolder = nullptr;
+	resultModel->RemoveSource(source);
+}
+
+void GlobalSearch::Search(const std::vector<GlobalSearchSource>& searchSources, const QString& query, bool regex, bool matchCase)
+{
+	Cancel();
+	// Tasks of the last search still reference their log holders, which might be gone before they finish
+	for (auto& source : sources)
+	{
+		source.task.waitForFinished();
+	}
+	sources.clear();
+	resultModel->Reset(searchSources);
+	if (query.isEmpty()) return;
+
+	SearchPattern pattern(query, regex, matchCase);
+	if (!pattern.IsValid())
+	{
+		emit SearchFailed(pattern.GetErrorString());
+		return;
+	}
+
+	for (uint32_t i = 0; i < searchSources.size(); i++)
+	{
+		SourceState& state = sources.emplace_back(SourceState { searchSources[i].logHolder, std::make_shared<std::atomic_bool>(false) });
+		emit SourceHitCountChanged(i, 0, false);
+		SearchTask task { currentGeneration, i, state.logHolder, pattern, state.cancelled };
+		state.task = QtConcurrent::run([this, task] { RunSearch(task); });
+	}
+}
+
+void GlobalSearch::RunSearch(const SearchTask& task)
+{
+	BlockProfiler profiler("Global search");
+	const std::vector<LogEntry>& entries = task.logHolder->GetEntries();
+	MessageStore::Reader reader(task.logHolder->GetMessageStore());
+	SearchScan scan(task.logHolder, task.pattern, *task.cancelled);
+	std::vector<GlobalSearchHit> batch;
+	size_t hitCount = 0;
+	uint64_t scannedBytes = 0;
+
+	const bool completed = scan.ForEachCandidate([&](const uint32_t entryIndex) {
+		const LogEntry& entry = entries[entryIndex];
+		const QString message = reader.GetMessage(entryIndex);
+		scannedBytes += message.size() * sizeof(QChar);
+		qsizetype start, length;
+		if (!task.pattern.FindFirst(message, start, length)) return;
+		batch.push_back({ task.logHolder->GetTimeStamp(&entry), task.source, entryIndex, static_cast<int>(start), static_cast<int>(length) });
+		hitCount++;
+
+		if (scan.ShouldPostBatch(batch.size()))
+		{
+			PostResults(task, std::move(batch), hitCount, false);
+			batch = {};
+		}
+	});
+
+	if (!completed) return;
+	profiler.SetProcessedBytes(scannedBytes);
+	PostResults(task, std::move(batch), hitCount, true);
+}
+
+void GlobalSearch::PostResults(const SearchTask& task, std::vector<GlobalSearchHit> results, size_t hitCount, bool finished)
+{
+	// Entries are visited in log order, only entries with a timestamp older than their predecessor need to move
+	std::sort(results.begin(), results.end());
+	QMetaObject::invokeMethod(this, [this, generation = task.generation, source = task.source, results = std::move(results), hitCount, finished] {
+		if (generation != currentGeneration || !sources[source].logHolder) return;
+		sources[source].finished = finished;
+		resultModel->MergeHits(results);
+		emit SourceHitCountChanged(source, hitCount, finished);
+	}, Qt::QueuedConnection);
+}
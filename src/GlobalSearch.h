@@ -0,0 +1,146 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QFuture>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "LogHolder.h"
+#include "SearchPattern.h"
+
+struct GlobalSearchSource
+{
+	QString name;
+	// Null once the source has been removed
+	const LogHolder* logHolder = nullptr;
+};
+
+struct GlobalSearchHit
+{
+	int64_t timeStamp;
+	uint32_t source, entryIndex;
+	int start, length;
+
+	// Merge order of the result list: by time, ties keep the order of the tabs and the log
+	[[nodiscard]] inline bool operator<(const GlobalSearchHit& other) const
+	{
+		if (timeStamp != other.timeStamp) return timeStamp < other.timeStamp;
+		if (source != other.source) return source < other.source;
+		return entryIndex < other.entryIndex;
+	}
+};
+
+/**
+ * The first hit of every matching entry of all sources, merged by timestamp.
+ */
+class GlobalSearchResultModel final : public QAbstractTableModel
+{
+	Q_OBJECT
+
+	// Above this many insert positions a batch gets merged with a model reset instead of single inserts
+	static constexpr size_t MAX_INSERT_GROUPS = 64;
+
+	std::vector<GlobalSearchSource> sources;
+	std::vector<GlobalSearchHit> hits;
+
+public:
+	enum Column { SOURCE, TIME, MESSAGE, COLUMN_COUNT };
+
+	explicit GlobalSearchResultModel(QObject* parent = nullptr) : QAbstractTableModel(parent) {}
+
+	~GlobalSearchResultModel() override = default;
+
+	void Reset(const std::vector<GlobalSearchSource>& searchSources);
+
+	// Expects a batch that is already sorted
+	void MergeHits(const std::vector<GlobalSearchHit>& batch);
+
+	void RemoveSource(uint32_t source);
+
+	[[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+	[[nodiscard]] int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+	[[nodiscard]] QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+	[[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	[[nodiscard]] const GlobalSearchHit* GetHit(int row) const;
+
+private:
+	[[nodiscard]] const LogEntry* GetEntry(const GlobalSearchHit& hit) const;
+};
+
+/**
+ * Searches several log holders at once, one task per holder on the global thread pool.
+ * Every task streams its hits in sorted batches, which get merged into the result model on the GUI thread.
+ */
+class GlobalSearch final : public QObject
+{
+	Q_OBJECT
+
+public:
+	GlobalSearch(GlobalSearchResultModel* resultModel, QObject* parent = nullptr);
+
+	~GlobalSearch() override;
+
+	void Search(const std::vector<GlobalSearchSource>& searchSources, const QString& query, bool regex, bool matchCase);
+
+	void Cancel();
+
+	// Stops searching the source and drops its results, must be called before its log holder gets destroyed
+	void RemoveSource(uint32_t source);
+
+	[[nodiscard]] bool IsSearching() const;
+
+signals:
+	void SourceHitCountChanged(uint32_t source, size_t hitCount, bool finished);
+
+	void SearchFailed(const QString& error);
+
+private:
+	struct SourceState
+	{
+		const LogHolder* logHolder;
+		std::shared_ptr<std::atomic_bool> cancelled;
+		QFuture<void> task;
+		bool finished = false;
+	};
+
+	struct SearchTask
+	{
+		uint64_t generation;
+		uint32_t source;
+		const LogHolder* logHolder;
+		SearchPattern pattern;
+		std::shared_ptr<std::atomic_bool> cancelled;
+	};
+
+	void RunSearch(const SearchTask& task);
+
+	void PostResults(const SearchTask& task, std::vector<GlobalSearchHit> results, size_t hitCount, bool finished);
+
+	GlobalSearchResultModel* resultModel;
+	uint64_t currentGeneration = 0;
+	std::vector<SourceState> sources;
+};
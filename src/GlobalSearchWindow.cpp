@@ -0,0 +1,113 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GlobalSearchWindow.h"
+#include "GlobalSearch.h"
+#include "LogViewerTab.h"
+#include <QHeaderView>
+#include <numeric>
+
+GlobalSearchWindow::GlobalSearchWindow(const QList<LogViewerTab*>& tabs, QWidget* parent)
+	: QMainWindow(parent), tabs(tabs), resultModel(new GlobalSearchResultModel(this)), search(new GlobalSearch(resultModel, this))
+{
+	ui.setupUi(this);
+	ui.matchCaseCheckBox->setChecked(true);
+	ui.resultsView->setModel(resultModel);
+	ui.resultsView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	ui.resultsView->verticalHeader()->setDefaultSectionSize(ui.resultsView->fontMetrics().height() + 4);
+	ui.resultSplitter->setStretchFactor(1, 4);
+
+	connect(search, &GlobalSearch::SourceHitCountChanged, this, &GlobalSearchWindow::OnSourceHitCountChanged);
+	connect(search, &GlobalSearch::SearchFailed, this, &GlobalSearchWindow::OnSearchFailed);
+	connect(ui.resultsView, &QTableView::activated, this, &GlobalSearchWindow::OnResultActivated);
+	connect(ui.resultsView, &QTableView::clicked, this, &GlobalSearchWindow::OnResultActivated);
+}
+
+GlobalSearchWindow::~GlobalSearchWindow()
+{
+	// The search tasks have to be stopped before the tabs get destroyed
+	delete search;
+}
+
+void GlobalSearchWindow::on_searchButton_clicked()
+{
+	StartSearch();
+}
+
+void GlobalSearchWindow::on_searchLineEdit_returnPressed()
+{
+	StartSearch();
+}
+
+void GlobalSearchWindow::StartSearch()
+{
+	searchedTabs = tabs;
+	sourceHitCounts.assign(searchedTabs.size(), 0);
+	std::vector<GlobalSearchSource> sources;
+	sources.reserve(searchedTabs.size());
+	ui.sourcesTable->setRowCount(static_cast<int>(searchedTabs.size()));
+	for (int i = 0; i < searchedTabs.size(); i++)
+	{
+		sources.push_back({ searchedTabs[i]->GetTabTitle(), &searchedTabs[i]->GetLogHolder() });
+		auto* nameItem = new QTableWidgetItem(searchedTabs[i]->GetTabIcon(), searchedTabs[i]->GetTabTitle());
+		nameItem->setToolTip(searchedTabs[i]->GetTabToolTip());
+		ui.sourcesTable->setItem(i, 0, nameItem);
+		ui.sourcesTable->setItem(i, 1, new QTableWidgetItem());
+	}
+	ui.statusLabel->clear();
+	search->Search(sources, ui.searchLineEdit->text(), ui.regexCheckBox->isChecked(), ui.matchCaseCheckBox->isChecked());
+}
+
+void GlobalSearchWindow::OnTabClosed(LogViewerTab* tab)
+{
+	const qsizetype source = searchedTabs.indexOf(tab);
+	if (source < 0) return;
+	search->RemoveSource(static_cast<uint32_t>(source));
+	searchedTabs[source] = nullptr;
+	sourceHitCounts[source] = 0;
+	ui.sourcesTable->item(static_cast<int>(source), 1)->setText(tr("closed"));
+	UpdateStatus();
+}
+
+void GlobalSearchWindow::OnSourceHitCountChanged(uint32_t source, size_t hitCount, bool finished)
+{
+	if (source >= sourceHitCounts.size()) return;
+	sourceHitCounts[source] = hitCount;
+	QTableWidgetItem* countItem = ui.sourcesTable->item(static_cast<int>(source), 1);
+	if (countItem) countItem->setText(finished ? QString::number(hitCount) : tr("%1 (searching)").arg(hitCount));
+	UpdateStatus();
+}
+
+void GlobalSearchWindow::OnSearchFailed(const QString& error)
+{
+	ui.statusLabel->setText(tr("Invalid regex: %1").arg(error));
+}
+
+void GlobalSearchWindow::UpdateStatus()
+{
+	if (ui.searchLineEdit->text().isEmpty()) return;
+	const size_t total = std::accumulate(sourceHitCounts.begin(), sourceHitCounts.end(), size_t(0));
+	const QString text = tr("%n hit(s)", "", static_cast<int>(total));
+	ui.statusLabel->setText(search->IsSearching() ? tr("%1, searching...").arg(text) : text);
+}
+
+void GlobalSearchWindow::OnResultActivated(const QModelIndex& index)
+{
+	const GlobalSearchHit* hit = resultModel->GetHit(index.row());
+	if (!hit || hit->source >= static_cast<uint32_t>(searchedTabs.size()) || !searchedTabs[hit->source]) return;
+	emit HitActivated(searchedTabs[hit->source], SearchHit { hit->entryIndex, hit->start, hit->length });
+}
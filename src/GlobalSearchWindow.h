@@ -0,0 +1,72 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QMainWindow>
+#include <QList>
+#include "ui_GlobalSearchWindow.h"
+#include "SearchSession.h"
+
+class LogViewerTab;
+class GlobalSearch;
+class GlobalSearchResultModel;
+
+class GlobalSearchWindow final : public QMainWindow
+{
+	Q_OBJECT
+
+public:
+	GlobalSearchWindow(const QList<LogViewerTab*>& tabs, QWidget* parent = nullptr);
+
+	~GlobalSearchWindow() override;
+
+	// Has to be called before the tab gets destroyed
+	void OnTabClosed(LogViewerTab* tab);
+
+signals:
+	void HitActivated(LogViewerTab* tab, const SearchHit& hit);
+
+private slots:
+	void on_searchButton_clicked();
+
+	void on_searchLineEdit_returnPressed();
+
+	void OnSourceHitCountChanged(uint32_t source, size_t hitCount, bool finished);
+
+	void OnSearchFailed(const QString& error);
+
+	void OnResultActivated(const QModelIndex& index);
+
+private:
+	void StartSearch();
+
+	void UpdateStatus();
+
+	Ui::GlobalSearchWindowClass ui;
+
+	const QList<LogViewerTab*>& tabs;
+
+	// Tabs of the last search, indexed by the source index of the hits; closed tabs are set to null
+	QList<LogViewerTab*> searchedTabs;
+
+	std::vector<size_t> sourceHitCounts;
+
+	GlobalSearchResultModel* resultModel;
+
+	GlobalSearch* search;
+};
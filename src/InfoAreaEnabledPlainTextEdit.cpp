@@ -27,13 +27,28 @@ void InfoAreaEnabledPlainTextEdit::AddInfoAreaWidget(EditInfoAreaWidget* infoWid
 {
 	infoAreaWidgets.append(infoWidget);
 	infoWidget->SetOnWidthChangedEvent([this] { SetViewportMargins(0); });
+	infoWidget->show();
 	SetViewportMargins();
+	UpdateInfoAreaGeometry();
+}
+
+void InfoAreaEnabledPlainTextEdit::RemoveInfoAreaWidget(EditInfoAreaWidget* infoWidget)
+{
+	if (!infoAreaWidgets.removeOne(infoWidget)) return;
+	infoWidget->SetOnWidthChangedEvent([] {});
+	infoWidget->hide();
+	SetViewportMargins();
+	UpdateInfoAreaGeometry();
 }
 
 void InfoAreaEnabledPlainTextEdit::resizeEvent(QResizeEvent* event)
 {
 	QPlainTextEdit::resizeEvent(event);
+	UpdateInfoAreaGeometry();
+}
 
+void InfoAreaEnabledPlainTextEdit::UpdateInfoAreaGeometry()
+{
 	QRect cr = contentsRect();
 	int left = cr.left();
 	for (EditInfoAreaWidget* widget : infoAreaWidgets)
@@ -34,6 +34,10 @@ public:
 
 	void AddInfoAreaWidget(EditInfoAreaWidget* infoWidget);
 
+	void RemoveInfoAreaWidget(EditInfoAreaWidget* infoWidget);
+
+	[[nodiscard]] bool HasInfoAreaWidget(EditInfoAreaWidget* infoWidget) const { return infoAreaWidgets.contains(infoWidget); }
+
 protected:
 	void resizeEvent(QResizeEvent* event) override;
 
@@ -43,5 +47,7 @@ protected slots:
 	void UpdateMetaInfoSidebar(const QRect& rect, int dy);
 
 private:
+	void UpdateInfoAreaGeometry();
+
 	QList<EditInfoAreaWidget*> infoAreaWidgets;
 };
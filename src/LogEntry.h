@@ -34,12 +34,12 @@ public:
 
 struct LogEntry
 {
+	// Joins the lines of multi-line entries (like stack traces) in their messages
+	static constexpr char16_t LINE_BREAK = 0x23CE; // Return symbol
+
 	uint64_t entryNumber;
 	uint64_t lineNumber;
 	QDateTime timeStamp;
 	std::shared_ptr<LogLevel> level;
 	std::array<QString, 8> components;
-
-	std::chrono::microseconds sinceStart, sincePrevious;
-	QString sinceStartString, sincePreviousString;
 };
\ No newline at end of file
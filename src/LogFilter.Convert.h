@@ -28,7 +28,8 @@ namespace YAML
         static Node encode(const LogFilter& filter)
         {
             Node node;
-            //TODO
+            node["Name"] = filter.GetName();
+            node["Expression"] = filter.GetExpression();
             return node;
         }
 
@@ -36,7 +37,16 @@ namespace YAML
         {
             if (node.IsMap())
             {
-                //TODO
+                if (const auto expressionNode = node["Expression"])
+                {
+                    if (expressionNode.IsScalar())
+                    {
+                        // Parsed here once, applying the preset later only copies the parsed expression
+                        // Invalid expressions are kept, so saving the profile doesn't lose them
+                        filter = LogFilter(expressionNode.as<QString>(), node["Name"].as<QString>(expressionNode.as<QString>()));
+                        return true;
+                    }
+                }
             }
             return false;
         }
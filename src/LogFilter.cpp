@@ -16,3 +16,130 @@
  */
 
 #include "LogFilter.h"
+#include <QObject>
+#include <algorithm>
+
+LogFilter::LogFilter() : key(QStringLiteral("all")), root(std::make_shared<FilterNode>())
+{}
+
+LogFilter::LogFilter(const QString& expression, const QString& name)
+	: name(name), expression(expression), root(FilterParser::Parse(expression, error))
+{
+	if (!root) return;
+	CollectConjunction(*root);
+	std::sort(conjunction.begin(), conjunction.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+	conjunction.erase(std::unique(conjunction.begin(), conjunction.end(), [](const auto& a, const auto& b) { return a.first == b.first; }), conjunction.end());
+
+	QStringList keys;
+	for (const auto& restriction : conjunction)
+	{
+		keys.append(restriction.first);
+	}
+	key = keys.isEmpty() ? QStringLiteral("all") : keys.join(QLatin1String(" and "));
+}
+
+void LogFilter::CollectConjunction(const FilterNode& node)
+{
+	if (node.type == FilterNode::AND)
+	{
+		for (const auto& child : node.children) CollectConjunction(*child);
+	}
+	else if (node.type != FilterNode::ALL)
+	{
+		conjunction.emplace_back(node.ToKey(), &node);
+	}
+}
+
+bool LogFilter::ShowEntry(const LogEntry& logEntry, int64_t timeStamp) const
+{
+	return root && Evaluate(*root, logEntry, timeStamp);
+}
+
+QString LogFilter::GetIngestError() const
+{
+	if (!root) return error;
+	if (ContainsNode(*root, [](const FilterNode& node) { return node.type == FilterNode::TEMPLATE_IN; }))
+	{
+		return QObject::tr("Templates are mined after loading, they can't be used to filter while loading");
+	}
+	if (ContainsNode(*root, [](const FilterNode& node) { return node.type == FilterNode::TIME_RANGE && node.timeOfDay; }))
+	{
+		return QObject::tr("Times of day need the day the log starts, use a date and time to filter while loading");
+	}
+	return {};
+}
+
+bool LogFilter::HasTimeRestriction() const
+{
+	return root && ContainsNode(*root, [](const FilterNode& node) { return node.type == FilterNode::TIME_RANGE; });
+}
+
+bool LogFilter::MayShowLevel(const QString& levelName) const
+{
+	return std::all_of(conjunction.begin(), conjunction.end(), [&levelName](const auto& restriction) {
+		return !IsLevelOnly(*restriction.second) || EvaluateLevel(*restriction.second, levelName);
+	});
+}
+
+bool LogFilter::ContainsNode(const FilterNode& node, const std::function<bool(const FilterNode&)>& predicate)
+{
+	return predicate(node) || std::any_of(node.children.begin(), node.children.end(), [&predicate](const auto& child) { return ContainsNode(*child, predicate); });
+}
+
+bool LogFilter::IsLevelOnly(const FilterNode& node)
+{
+	switch (node.type)
+	{
+	case FilterNode::LEVEL_IN:
+		return true;
+	case FilterNode::AND:
+	case FilterNode::OR:
+	case FilterNode::NOT:
+		return std::all_of(node.children.begin(), node.children.end(), [](const auto& child) { return IsLevelOnly(*child); });
+	default:
+		return false;
+	}
+}
+
+bool LogFilter::EvaluateLevel(const FilterNode& node, const QString& levelName)
+{
+	switch (node.type)
+	{
+	case FilterNode::AND:
+		return std::all_of(node.children.begin(), node.children.end(), [&](const auto& child) { return EvaluateLevel(*child, levelName); });
+	case FilterNode::OR:
+		return std::any_of(node.children.begin(), node.children.end(), [&](const auto& child) { return EvaluateLevel(*child, levelName); });
+	case FilterNode::NOT:
+		return !EvaluateLevel(*node.children.front(), levelName);
+	default:
+		return node.values.contains(levelName, Qt::CaseInsensitive);
+	}
+}
+
+bool LogFilter::Evaluate(const FilterNode& node, const LogEntry& logEntry, int64_t timeStamp)
+{
+	switch (node.type)
+	{
+	case FilterNode::ALL:
+		return true;
+	case FilterNode::AND:
+		return std::all_of(node.children.begin(), node.children.end(), [&](const auto& child) { return Evaluate(*child, logEntry, timeStamp); });
+	case FilterNode::OR:
+		return std::any_of(node.children.begin(), node.children.end(), [&](const auto& child) { return Evaluate(*child, logEntry, timeStamp); });
+	case FilterNode::NOT:
+		return !Evaluate(*node.children.front(), logEntry, timeStamp);
+	case FilterNode::LEVEL_IN:
+		return logEntry.level && node.values.contains(logEntry.level->GetLevelName(), Qt::CaseInsensitive);
+	case FilterNode::TEMPLATE_IN:
+		// Templates are mined by the log holder, a single entry doesn't know its template
+		return false;
+	case FilterNode::TEXT_IN:
+		return node.values.contains(logEntry.components[node.component]);
+	case FilterNode::TIME_RANGE:
+		if (node.timeOfDay) return false;
+		return (!node.hasFrom || timeStamp >= node.from.toMSecsSinceEpoch()) && (!node.hasTo || timeStamp < node.to.toMSecsSinceEpoch());
+	case FilterNode::PATTERN:
+		return node.pattern.Matches(logEntry.components[node.component]);
+	}
+	return false;
+}
@@ -18,13 +18,75 @@
 #pragma once
 
 #include "LogEntry.h"
+#include "FilterExpression.h"
+#include <functional>
+#include <memory>
+#include <vector>
 
+/**
+ * A filter expression, parsed once on construction.
+ * ShowEntry evaluates the expression for a single entry as parsed, e.g. by ingest filters, whole logs get filtered with a FilterPlan.
+ * Template ids and the day a log starts are only known to a log holder, ShowEntry treats template and time of day
+ * restrictions as never matching, GetIngestError reports them.
+ */
 class LogFilter final
 {
+	QString name, expression, error, key;
+	std::shared_ptr<const FilterNode> root;
+	// Operands of the top level and, sorted by their key
+	std::vector<std::pair<QString, const FilterNode*>> conjunction;
+
 public:
-	LogFilter() = default;
+	// An empty filter shows every entry
+	LogFilter();
+
+	explicit LogFilter(const QString& expression, const QString& name = QString());
 
 	~LogFilter() = default;
 
-	virtual bool ShowEntry(const LogEntry& logEntry) { return true; }
+	[[nodiscard]] bool IsValid() const { return root != nullptr; }
+
+	[[nodiscard]] const QString& GetError() const { return error; }
+
+	[[nodiscard]] const QString& GetName() const { return name; }
+
+	void SetName(const QString& filterName) { name = filterName; }
+
+	[[nodiscard]] const QString& GetExpression() const { return expression; }
+
+	[[nodiscard]] bool ShowsAll() const { return root && root->type == FilterNode::ALL; }
+
+	// Null if the expression is invalid
+	[[nodiscard]] const FilterNode* GetRoot() const { return root.get(); }
+
+	// The timestamp (ms since epoch) is the one the entry counts as, entries without one inherit it from their predecessor
+	[[nodiscard]] bool ShowEntry(const LogEntry& logEntry, int64_t timeStamp) const;
+
+	// Why the filter can't be applied while parsing a log, empty if it can
+	[[nodiscard]] QString GetIngestError() const;
+
+	[[nodiscard]] bool HasTimeRestriction() const;
+
+	// False if the level alone rules the entry out, restrictions on anything else are assumed to match
+	[[nodiscard]] bool MayShowLevel(const QString& levelName) const;
+
+	/**
+	 * The filter as list of restrictions that all have to be met, as (key, node) sorted by key.
+	 * A filter whose restrictions include all restrictions of another one only shows a subset of its entries.
+	 */
+	[[nodiscard]] const std::vector<std::pair<QString, const FilterNode*>>& GetConjunction() const { return conjunction; }
+
+	// Normalised expression, equal for filters that only differ in formatting or in the order of their restrictions
+	[[nodiscard]] const QString& GetKey() const { return key; }
+
+private:
+	void CollectConjunction(const FilterNode& node);
+
+	[[nodiscard]] static bool Evaluate(const FilterNode& node, const LogEntry& logEntry, int64_t timeStamp);
+
+	[[nodiscard]] static bool ContainsNode(const FilterNode& node, const std::function<bool(const FilterNode&)>& predicate);
+
+	[[nodiscard]] static bool IsLevelOnly(const FilterNode& node);
+
+	[[nodiscard]] static bool EvaluateLevel(const FilterNode& node, const QString& levelName);
 };
@@ -17,59 +17,458 @@
 
 #include "LogHolder.h"
 #include "LogParser.h"
+#include "LogFilter.h"
+#include "FilterPlan.h"
 #include "Profiler.hpp"
+#include <QHash>
+#include <QtConcurrent>
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
+namespace
+{
+	// Smaller logs are filtered on the calling thread, the thread pool overhead would outweigh the gain
+	constexpr size_t MIN_PARALLEL_ENTRIES = 65536;
+	constexpr size_t MIN_CHUNK_SIZE = 16384;
+	constexpr size_t FILTER_CACHE_SIZE = 16;
+	constexpr size_t FILTER_CACHE_MEMORY_LIMIT = 256 * 1024 * 1024;
+	constexpr size_t FILTER_NAVIGATION_SIZE = 100;
+
+	/**
+	 * Splits [0, count) into chunks that are processed on the global thread pool.
+	 * Every chunk collects its results into its own buffer and the buffers get concatenated in chunk order,
+	 * so the result is identical to a single serial pass.
+	 */
+	template<typename T, typename Collect>
+	std::vector<T> ParallelCollect(size_t count, const Collect& collect)
+	{
+		std::vector<T> result;
+		if (count < MIN_PARALLEL_ENTRIES)
+		{
+			collect(0, count, result);
+			return result;
+		}
+
+		struct Chunk
+		{
+			size_t begin, end, offset;
+			std::vector<T> output;
+		};
+		// A few chunks per thread, so threads that finish early can take over work
+		const size_t chunkCount = std::clamp<size_t>(count / MIN_CHUNK_SIZE, 1, QThreadPool::globalInstance()->maxThreadCount() * 4);
+		std::vector<Chunk> chunks(chunkCount);
+		for (size_t i = 0; i < chunkCount; i++)
+		{
+			chunks[i].begin = count * i / chunkCount;
+			chunks[i].end = count * (i + 1) / chunkCount;
+		}
+		QtConcurrent::blockingMap(chunks, [&collect](Chunk& chunk) { collect(chunk.begin, chunk.end, chunk.output); });
+
+		size_t total = 0;
+		for (Chunk& chunk : chunks)
+		{
+			chunk.offset = total;
+			total += chunk.output.size();
+		}
+		result.resize(total);
+		QtConcurrent::blockingMap(chunks, [&result](Chunk& chunk) { std::copy(chunk.output.begin(), chunk.output.end(), result.begin() + chunk.offset); });
+		return result;
+	}
+}
+
+LogHolder::~LogHolder()
+{
+	StopIndexing();
+}
 
 void LogHolder::Load(LogParser &parser)
 {
+	StopIndexing();
+	{
+		std::lock_guard lock(filterCacheMutex);
+		filterCache.clear();
+		loadGeneration++;
+	}
+	filterNavigation.clear();
+	filterNavigationIndex = 0;
+	expandedRuns.clear();
 	{
 		BlockProfiler parseProfiler("Parse log");
 		logEntries = parser.Parse();
 		systemInfo = parser.GetSystemInfo();
 		logProfile = parser.GetUsedProfile();
 		usedLogProfiles = parser.GetUsedLogLevels();
+		droppedEntryCount = parser.GetDroppedEntryCount();
 	}
 	PreprocessLogEntries();
+	searchIndex = std::make_unique<TrigramIndex>();
+	UpdateSearchIndex();
+}
+
+void LogHolder::UpdateSearchIndex()
+{
+	if (!searchIndex || indexingTask.isRunning() || searchIndex->GetIndexedEntryCount() == logEntries.size()) return;
+	indexingTask = QtConcurrent::run([this] { searchIndex->Update(messageStore); });
+}
+
+void LogHolder::StopIndexing()
+{
+	if (!searchIndex) return;
+	searchIndex->Cancel();
+	indexingTask.waitForFinished();
 }
 
 void LogHolder::PreprocessLogEntries()
 {
+	BlockProfiler profiler("Preprocess log");
+	const size_t count = logEntries.size();
+	timeStamps.resize(count);
+	timeSinceStart.resize(count);
+	timeSincePrevious.resize(count);
+	levelIds.resize(count);
+	threadIds.resize(count);
+	subSystemIds.resize(count);
+	templateIds.resize(count);
+	templateMiner = TemplateMiner();
+	threadNames.clear();
+	subSystemNames.clear();
+	levelBitmaps.clear();
+	threadBitmaps.clear();
+	subSystemBitmaps.clear();
+	zoneMap = ZoneMap();
+	timeSorted = true;
+	timeOrder.clear();
+	unfoldedEntries.assign((count + 63) / 64, 0);
+	messageStore.Reference(logEntries);
 	if (logEntries.empty()) return;
-	const LogEntry* first = &logEntries[0];
-	const LogEntry* previous = &logEntries[0];
-	LogEntry* current = nullptr;
-	for (auto& logEntry : logEntries)
+
+	// Entries without a timestamp inherit the one of their predecessor, so they don't show up as time jumps
+	int64_t lastTimeStamp = 0;
+	bool foundTimeStamp = false;
+	for (size_t i = 0; i < count; i++)
+	{
+		const QDateTime& timeStamp = logEntries[i].timeStamp;
+		if (timeStamp.isValid())
+		{
+			lastTimeStamp = timeStamp.toMSecsSinceEpoch();
+			if (!foundTimeStamp)
+			{ // Backfill the entries before the first timestamp
+				std::fill(timeStamps.begin(), timeStamps.begin() + i, lastTimeStamp);
+				foundTimeStamp = true;
+			}
+		}
+		timeStamps[i] = lastTimeStamp;
+	}
+	timeSorted = std::is_sorted(timeStamps.begin(), timeStamps.end());
+	if (!timeSorted)
+	{ // Searches by time go through a sorted permutation instead
+		timeOrder.resize(count);
+		std::iota(timeOrder.begin(), timeOrder.end(), 0u);
+		std::stable_sort(timeOrder.begin(), timeOrder.end(), [this](uint32_t a, uint32_t b) { return timeStamps[a] < timeStamps[b]; });
+	}
+
+	// Tight loops over the contiguous column, allowing the compiler to vectorise them
+	const int64_t* stamps = timeStamps.data();
+	int64_t* sinceStart = timeSinceStart.data();
+	int64_t* sincePrevious = timeSincePrevious.data();
+	const int64_t start = stamps[0];
+	for (size_t i = 0; i < count; i++)
+	{
+		sinceStart[i] = stamps[i] - start;
+	}
+	sincePrevious[0] = 0;
+	for (size_t i = 1; i < count; i++)
 	{
-		current = &logEntry;
-		previous = current;
+		sincePrevious[i] = stamps[i] - stamps[i - 1];
+	}
+
+	// Dictionary encoded columns for the filters, comparing small ids instead of strings
+	std::unordered_map<const LogLevel*, uint16_t> levelIndex;
+	for (size_t i = 0; i < usedLogProfiles.size() && i < NO_LEVEL; i++)
+	{
+		levelIndex.emplace(usedLogProfiles[i].get(), static_cast<uint16_t>(i));
+	}
+	const auto encode = [count, this](LogComponent::Component component, std::vector<uint32_t>& ids, std::vector<QString>& names) {
+		QHash<QString, uint32_t> dictionary;
+		for (size_t i = 0; i < count; i++)
+		{
+			const QString& value = logEntries[i].components[component];
+			auto it = dictionary.find(value);
+			if (it == dictionary.end())
+			{
+				it = dictionary.insert(value, static_cast<uint32_t>(names.size()));
+				names.push_back(value);
+			}
+			ids[i] = it.value();
+		}
+	};
+	encode(LogComponent::THREAD, threadIds, threadNames);
+	encode(LogComponent::SUB_SYS, subSystemIds, subSystemNames);
+	for (size_t i = 0; i < count; i++)
+	{
+		const auto it = levelIndex.find(logEntries[i].level.get());
+		levelIds[i] = it == levelIndex.end() ? NO_LEVEL : it->second;
+	}
+
+	// Bitmaps per id, so filters on these columns become set operations instead of scans
+	const auto buildBitmaps = [count](const auto& ids, size_t idCount, std::vector<RoaringBitmap>& bitmaps) {
+		bitmaps.resize(idCount);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (ids[i] < idCount) bitmaps[ids[i]].Add(static_cast<uint32_t>(i));
+		}
+	};
+	buildBitmaps(levelIds, std::min<size_t>(usedLogProfiles.size(), NO_LEVEL), levelBitmaps);
+	buildBitmaps(threadIds, threadNames.size(), threadBitmaps);
+	buildBitmaps(subSystemIds, subSystemNames.size(), subSystemBitmaps);
+
+	zoneMap.Build(logEntries, timeStamps, levelIds);
+
+	// Templates evolve with every message, so mining is a single sequential pass
+	{
+		BlockProfiler templateProfiler("Mine message templates");
+		for (size_t i = 0; i < count; i++)
+		{
+			templateIds[i] = templateMiner.Add(logEntries[i].components[LogComponent::MESSAGE]);
+		}
+	}
+
+	if (compressMessages)
+	{
+		// The parser extracts the components as views into the original message, they need their own copies before it gets dropped
+		const auto detach = [](QString& text) { text = QString(text.constData(), text.size()); };
+		std::for_each(threadNames.begin(), threadNames.end(), detach);
+		std::for_each(subSystemNames.begin(), subSystemNames.end(), detach);
+		for (size_t i = 0; i < count; i++)
+		{
+			auto& components = logEntries[i].components;
+			components[LogComponent::THREAD] = threadNames[threadIds[i]];
+			components[LogComponent::SUB_SYS] = subSystemNames[subSystemIds[i]];
+			detach(components[LogComponent::DATE]);
+			detach(components[LogComponent::TIME]);
+			detach(components[LogComponent::WHERE]);
+		}
+		messageStore.Compress(logEntries);
 	}
 }
 
 void LogHolder::Filter(const std::function<bool(const LogEntry &)> &filterFunction)
 {
 	BlockProfiler parseProfiler("Filter log");
-	std::vector<const LogEntry*> newlyFilteredLog;
-	newlyFilteredLog.reserve(logEntries.size());
+	{
+		std::lock_guard lock(filterCacheMutex);
+		filterCache.clear();
+	}
+	filterHits = std::make_shared<std::vector<const LogEntry*>>(ParallelCollect<const LogEntry*>(logEntries.size(),
+		[&](size_t begin, size_t end, std::vector<const LogEntry*>& output) {
+			for (size_t i = begin; i < end; i++)
+			{
+				if (filterFunction(logEntries[i])) output.push_back(&logEntries[i]);
+			}
+		}));
+	UpdateShownEntries();
+}
+
+void LogHolder::Filter(const LogFilter& filter)
+{
+	SetFilterResult(filter, EvaluateFilter(filter));
+}
+
+std::shared_ptr<const std::vector<const LogEntry*>> LogHolder::EvaluateFilter(const LogFilter& filter, const std::atomic_bool* cancelled) const
+{
+	if (!filter.IsValid()) return std::make_shared<std::vector<const LogEntry*>>();
 
-	for (const LogEntry& entry : logEntries)
+	// Look for the recent result that needs the fewest entries to be tested, a full pass tests all of them
+	const auto& restrictions = filter.GetConjunction();
+	const auto byKey = [](const auto& a, const auto& b) { return a.first < b.first; };
+	std::optional<FilterState> base;
+	bool widen = false;
 	{
-		if (filterFunction(entry))
+		std::lock_guard lock(filterCacheMutex);
+		size_t cost = logEntries.size();
+		for (const FilterState& state : filterCache)
 		{
-			newlyFilteredLog.push_back(&entry);
+			if (state.loadGeneration != loadGeneration) continue;
+			const auto& previous = state.filter.GetConjunction();
+			const bool refines = std::includes(restrictions.begin(), restrictions.end(), previous.begin(), previous.end(), byKey);
+			const bool widens = std::includes(previous.begin(), previous.end(), restrictions.begin(), restrictions.end(), byKey);
+			const size_t shown = state.entries->size();
+			if (refines && widens)
+			{ // Same restrictions, maybe written differently
+				return state.entries;
+			}
+			if (refines && shown < cost)
+			{
+				base = state;
+				widen = false;
+				cost = shown;
+			}
+			else if (widens && logEntries.size() - shown < cost)
+			{
+				base = state;
+				widen = true;
+				cost = logEntries.size() - shown;
+			}
 		}
 	}
 
-	filteredLogEntries = std::move(newlyFilteredLog);
+	std::vector<const LogEntry*> result;
+	if (!base)
+	{
+		BlockProfiler profiler("Filter log");
+		const FilterPlan plan(filter, *this);
+		result = ParallelCollect<const LogEntry*>(logEntries.size(), [&](size_t begin, size_t end, std::vector<const LogEntry*>& output) {
+			if (cancelled && *cancelled) return;
+			std::vector<uint32_t> matches;
+			plan.Evaluate(static_cast<uint32_t>(begin), static_cast<uint32_t>(end), matches);
+			output.reserve(matches.size());
+			for (const uint32_t index : matches)
+			{
+				output.push_back(&logEntries[index]);
+			}
+		});
+	}
+	else if (widen)
+	{
+		BlockProfiler profiler("Widen filter");
+		result = Widen(*base->entries, filter, cancelled);
+	}
+	else
+	{
+		BlockProfiler profiler("Refine filter");
+		const auto& previous = base->filter.GetConjunction();
+		std::vector<const FilterNode*> added;
+		for (const auto& restriction : restrictions)
+		{
+			if (!std::binary_search(previous.begin(), previous.end(), restriction, byKey)) added.push_back(restriction.second);
+		}
+		result = Refine(*base->entries, added, cancelled);
+	}
+	if (cancelled && *cancelled) return nullptr;
+	return std::make_shared<std::vector<const LogEntry*>>(std::move(result));
+}
+
+void LogHolder::SetFilterResult(const LogFilter& filter, std::shared_ptr<const std::vector<const LogEntry*>> entries)
+{
+	filterHits = std::move(entries);
+	UpdateShownEntries();
+	if (!filter.IsValid()) return;
+	AddToFilterNavigation(filter);
+
+	std::lock_guard lock(filterCacheMutex);
+	const auto sameFilter = std::find_if(filterCache.begin(), filterCache.end(), [&filter](const FilterState& state) { return state.filter.GetKey() == filter.GetKey(); });
+	if (sameFilter != filterCache.end()) filterCache.erase(sameFilter);
+	filterCache.push_back({ filter, filterHits, loadGeneration });
+	// Evict the least recently used results, the shown one always stays
+	while (filterCache.size() > 1 && (filterCache.size() > FILTER_CACHE_SIZE || GetFilterCacheMemoryUsage() > FILTER_CACHE_MEMORY_LIMIT))
+	{
+		filterCache.pop_front();
+	}
+}
+
+std::shared_ptr<const std::vector<const LogEntry*>> LogHolder::GetCachedFilterResult(const LogFilter& filter) const
+{
+	if (!filter.IsValid()) return nullptr;
+	std::lock_guard lock(filterCacheMutex);
+	for (const FilterState& state : filterCache)
+	{
+		if (state.loadGeneration == loadGeneration && state.filter.GetKey() == filter.GetKey()) return state.entries;
+	}
+	return nullptr;
 }
 
-void LogHolder::Load(QFile *file)
+LogHolder::FilterCacheInfo LogHolder::GetFilterCacheInfo() const
+{
+	std::lock_guard lock(filterCacheMutex);
+	return { filterCache.size(), GetFilterCacheMemoryUsage(), FILTER_CACHE_MEMORY_LIMIT };
+}
+
+size_t LogHolder::GetFilterCacheMemoryUsage() const
+{
+	// Results can be shared between filters, e.g. when adding a restriction didn't remove anything
+	std::vector<const std::vector<const LogEntry*>*> counted;
+	size_t usage = 0;
+	for (const FilterState& state : filterCache)
+	{
+		if (std::find(counted.begin(), counted.end(), state.entries.get()) != counted.end()) continue;
+		counted.push_back(state.entries.get());
+		usage += state.entries->capacity() * sizeof(const LogEntry*);
+	}
+	return usage;
+}
+
+void LogHolder::AddToFilterNavigation(const LogFilter& filter)
+{
+	// Applying the filter that navigation went to doesn't change the navigation
+	if (!filterNavigation.empty() && filterNavigation[filterNavigationIndex].GetKey() == filter.GetKey()) return;
+	if (!filterNavigation.empty()) filterNavigation.resize(filterNavigationIndex + 1);
+	filterNavigation.push_back(filter);
+	if (filterNavigation.size() > FILTER_NAVIGATION_SIZE) filterNavigation.erase(filterNavigation.begin());
+	filterNavigationIndex = filterNavigation.size() - 1;
+}
+
+std::vector<const LogEntry*> LogHolder::Refine(const std::vector<const LogEntry*>& shown, const std::vector<const FilterNode*>& addedRestrictions, const std::atomic_bool* cancelled) const
+{
+	const FilterPlan plan(addedRestrictions, *this);
+	return ParallelCollect<const LogEntry*>(shown.size(), [&](size_t begin, size_t end, std::vector<const LogEntry*>& output) {
+		if (cancelled && *cancelled) return;
+		std::vector<uint32_t> candidates, matches;
+		candidates.reserve(end - begin);
+		for (size_t i = begin; i < end; i++)
+		{
+			candidates.push_back(static_cast<uint32_t>(shown[i] - logEntries.data()));
+		}
+		plan.Evaluate(candidates, matches);
+		output.reserve(matches.size());
+		for (const uint32_t index : matches)
+		{
+			output.push_back(&logEntries[index]);
+		}
+	});
+}
+
+std::vector<const LogEntry*> LogHolder::Widen(const std::vector<const LogEntry*>& shown, const LogFilter& filter, const std::atomic_bool* cancelled) const
+{
+	const FilterPlan plan(filter, *this);
+	return ParallelCollect<const LogEntry*>(logEntries.size(), [&](size_t begin, size_t end, std::vector<const LogEntry*>& output) {
+		if (cancelled && *cancelled) return;
+		// Everything the narrower filter showed stays, only the entries it hid need to be tested
+		const auto shownBegin = std::lower_bound(shown.begin(), shown.end(), &logEntries[begin]);
+		const auto shownEnd = std::lower_bound(shownBegin, shown.end(), logEntries.data() + end);
+		std::vector<uint32_t> hidden, matches;
+		auto next = shownBegin;
+		for (size_t i = begin; i < end; i++)
+		{
+			if (next != shownEnd && *next == &logEntries[i]) ++next;
+			else hidden.push_back(static_cast<uint32_t>(i));
+		}
+		plan.Evaluate(hidden, matches);
+
+		output.reserve(static_cast<size_t>(shownEnd - shownBegin) + matches.size());
+		auto match = matches.begin();
+		for (auto it = shownBegin; it != shownEnd; ++it)
+		{
+			for (; match != matches.end() && &logEntries[*match] < *it; ++match) output.push_back(&logEntries[*match]);
+			output.push_back(*it);
+		}
+		for (; match != matches.end(); ++match) output.push_back(&logEntries[*match]);
+	});
+}
+
+void LogHolder::Load(QFile *file, const LogFilter& ingestFilter)
 {
 	LogParser parser(file);
+	parser.SetIngestFilter(ingestFilter);
 	Load(parser);
 }
 
-void LogHolder::Load(const QString &log)
+void LogHolder::Load(const QString &log, const LogFilter& ingestFilter)
 {
 	LogParser parser(log);
+	parser.SetIngestFilter(ingestFilter);
 	Load(parser);
 }
 
@@ -79,28 +478,241 @@ void LogHolder::Load(const std::string &filePath)
 	Load(&f);
 }
 
-std::vector<const LogEntry*> LogHolder::Find(const std::function<bool(const LogEntry&)>& searchFilter) const
+std::vector<const LogEntry*> LogHolder::Find(const std::function<bool(const LogEntry&)>& searchFilter, const QStringList& requiredLiterals) const
 {
-	std::vector<const LogEntry*> result;
-	for(const auto& entry : logEntries)
+	const std::vector<uint64_t> trigrams = ZoneMap::GetTrigrams(requiredLiterals);
+	return ParallelCollect<const LogEntry*>(logEntries.size(), [&](size_t begin, size_t end, std::vector<const LogEntry*>& output) {
+		for (size_t chunkStart = begin; chunkStart < end;)
+		{
+			const size_t chunk = chunkStart / ZoneMap::CHUNK_SIZE;
+			const size_t chunkEnd = std::min(end, (chunk + 1) * ZoneMap::CHUNK_SIZE);
+			if (trigrams.empty() || zoneMap.MayContainTrigrams(chunk, trigrams))
+			{
+				for (size_t i = chunkStart; i < chunkEnd; i++)
+				{
+					if (searchFilter(logEntries[i])) output.push_back(&logEntries[i]);
+				}
+			}
+			chunkStart = chunkEnd;
+		}
+	});
+}
+
+std::vector<const LogEntry*> LogHolder::FindFiltered(const std::function<bool(const LogEntry&)>& searchFilter) const
+{
+	const auto snapshot = filteredLogEntries;
+	const auto& entries = *snapshot;
+	return ParallelCollect<const LogEntry*>(entries.size(), [&](size_t begin, size_t end, std::vector<const LogEntry*>& output) {
+		for (size_t i = begin; i < end; i++)
+		{
+			if (searchFilter(*entries[i])) output.push_back(entries[i]);
+		}
+	});
+}
+
+const LogEntry* LogHolder::GetEntryForLine(uint64_t lineNumber) const
+{
+	if (logEntries.empty()) return nullptr;
+	// Entries are sorted by their first line, so the entry is the last one starting at or before the line
+	const auto it = std::upper_bound(logEntries.begin(), logEntries.end(), lineNumber,
+									 [](uint64_t line, const LogEntry& entry) { return line < entry.lineNumber; });
+	return it == logEntries.begin() ? &logEntries.front() : &*(it - 1);
+}
+
+int64_t LogHolder::GetFilteredRow(const LogEntry* entry) const
+{
+	// Filtered entries are always kept in log order
+	const auto it = std::lower_bound(filteredLogEntries->begin(), filteredLogEntries->end(), entry);
+	if (it == filteredLogEntries->end() || *it != entry) return -1;
+	return it - filteredLogEntries->begin();
+}
+
+void LogHolder::SetFilterContext(size_t before, size_t after)
+{
+	if (before == contextBefore && after == contextAfter) return;
+	contextBefore = before;
+	contextAfter = after;
+	UpdateShownEntries();
+}
+
+std::shared_ptr<const std::vector<const LogEntry*>> LogHolder::ExpandToContext(const std::shared_ptr<const std::vector<const LogEntry*>>& hits) const
+{
+	if (!HasFilterContext() || hits->empty() || hits->size() == logEntries.size()) return hits;
+	BlockProfiler profiler("Expand filter context");
+	auto shown = std::make_shared<std::vector<const LogEntry*>>();
+	shown->reserve(std::min(logEntries.size(), hits->size() * (contextBefore + contextAfter + 1)));
+	// Hits are ascending, so every range either overlaps the previous one or starts behind it
+	size_t next = 0;
+	for (const LogEntry* hit : *hits)
 	{
-		if (searchFilter(entry))
+		const size_t index = GetEntryIndex(hit);
+		const size_t end = std::min(logEntries.size(), index + contextAfter + 1);
+		for (size_t i = std::max(next, index - std::min(index, contextBefore)); i < end; i++)
 		{
-			result.push_back(&entry);
+			shown->push_back(&logEntries[i]);
 		}
+		next = end;
 	}
-	return result;
+	return shown;
 }
 
-std::vector<const LogEntry*> LogHolder::FindFiltered(const std::function<bool(const LogEntry&)>& searchFilter) const
+bool LogHolder::IsFilteredGap(size_t row) const
 {
-	std::vector<const LogEntry*> result;
-	for(const auto& entry : filteredLogEntries)
+	const auto& shown = *filteredLogEntries;
+	if (row == 0 || row >= shown.size()) return false;
+	// A collapsed run covers the entries up to its end
+	const size_t covered = IsRunExpanded(row - 1) ? 1 : std::max<uint32_t>(GetRunLength(row - 1), 1);
+	return GetEntryIndex(shown[row]) != GetEntryIndex(shown[row - 1]) + covered;
+}
+
+std::vector<uint64_t> LogHolder::CountTemplates(const std::vector<const LogEntry*>& entries) const
+{
+	std::vector<uint64_t> counts(templateMiner.GetTemplateCount(), 0);
+	for (const LogEntry* entry : entries)
 	{
-		if (searchFilter(*entry))
+		counts[GetTemplateId(entry)]++;
+	}
+	return counts;
+}
+
+void LogHolder::SetUnfolded(const LogEntry* entry, bool unfolded)
+{
+	const size_t index = GetEntryIndex(entry);
+	const uint64_t bit = uint64_t(1) << (index % 64);
+	if (unfolded) unfoldedEntries[index / 64] |= bit;
+	else unfoldedEntries[index / 64] &= ~bit;
+}
+
+QString LogHolder::GetDisplayedMessage(const LogEntry* entry) const
+{
+	const QString message = GetMessage(entry);
+	const qsizetype firstLineEnd = message.indexOf(QChar(LogEntry::LINE_BREAK));
+	if (firstLineEnd < 0) return message;
+	if (!IsUnfolded(entry)) return message.left(firstLineEnd);
+	// Line separators break the line without starting a new block, so the entry stays a single row of the view
+	QString lines = message;
+	return lines.replace(QChar(LogEntry::LINE_BREAK), QChar(QChar::LineSeparator));
+}
+
+void LogHolder::UpdateShownEntries()
+{
+	filteredLogEntries = CollapseRuns(ExpandToContext(filterHits));
+}
+
+void LogHolder::SetRepeatCollapse(RepeatCollapse collapse)
+{
+	if (collapse == repeatCollapse) return;
+	repeatCollapse = collapse;
+	expandedRuns.clear();
+	UpdateShownEntries();
+}
+
+bool LogHolder::IsRunExpanded(size_t row) const
+{
+	return row < runLengths.size() && runLengths[row] > 1 && expandedRuns.count((*filteredLogEntries)[row]) != 0;
+}
+
+void LogHolder::ToggleRun(size_t row)
+{
+	if (GetRunLength(row) < 2) return;
+	const LogEntry* first = (*filteredLogEntries)[row];
+	if (!expandedRuns.erase(first)) expandedRuns.insert(first);
+	UpdateShownEntries();
+}
+
+std::shared_ptr<const std::vector<const LogEntry*>> LogHolder::CollapseRuns(const std::shared_ptr<const std::vector<const LogEntry*>>& entries)
+{
+	runLengths.clear();
+	if (repeatCollapse == NO_COLLAPSE || entries->size() < 2) return entries;
+	BlockProfiler profiler("Collapse repeated entries");
+	const bool templates = repeatCollapse == SAME_TEMPLATE;
+	const auto& input = *entries;
+	auto shown = std::make_shared<std::vector<const LogEntry*>>();
+	bool repeated = false;
+	const auto addRun = [&](size_t begin, size_t end) {
+		const uint32_t length = static_cast<uint32_t>(end - begin);
+		repeated |= length > 1;
+		if (length > 1 && expandedRuns.count(input[begin]))
 		{
-			result.push_back(entry);
+			for (size_t i = begin; i < end; i++)
+			{
+				shown->push_back(input[i]);
+				runLengths.push_back(i == begin ? length : 0);
+			}
+			return;
 		}
+		shown->push_back(input[begin]);
+		runLengths.push_back(length);
+	};
+
+	size_t runStart = 0;
+	if (templates)
+	{
+		for (size_t i = 1; i < input.size(); i++)
+		{
+			if (GetTemplateId(input[i]) == GetTemplateId(input[i - 1])) continue;
+			addRun(runStart, i);
+			runStart = i;
+		}
+	}
+	else
+	{
+		MessageStore::Reader reader(messageStore);
+		QString runMessage;
+		size_t runHash = 0;
+		for (size_t i = 0; i < input.size(); i++)
+		{
+			const QString message = reader.GetMessage(GetEntryIndex(input[i]));
+			const size_t hash = qHash(message);
+			if (i > 0 && hash == runHash && message == runMessage) continue;
+			if (i > 0) addRun(runStart, i);
+			runStart = i;
+			runHash = hash;
+			// The message points into the block of the reader, which gets replaced once it moves on
+			runMessage = QString(message.constData(), message.size());
+		}
+	}
+	addRun(runStart, input.size());
+	// Nothing repeated, the view can keep using the input
+	if (!repeated)
+	{
+		runLengths.clear();
+		return entries;
+	}
+	return shown;
+}
+
+int64_t LogHolder::ResolveTime(const QDateTime& dateTime, int time, bool timeOfDay) const
+{
+	if (!timeOfDay) return dateTime.toMSecsSinceEpoch();
+	const QDate day = timeStamps.empty() ? QDate::currentDate() : QDateTime::fromMSecsSinceEpoch(timeStamps.front()).date();
+	return QDateTime(day, QTime(0, 0)).addMSecs(time).toMSecsSinceEpoch();
+}
+
+std::pair<uint32_t, uint32_t> LogHolder::GetEntryRangeForTime(int64_t from, int64_t to) const
+{
+	if (!timeSorted) return { 0, static_cast<uint32_t>(timeStamps.size()) };
+	const auto first = std::lower_bound(timeStamps.begin(), timeStamps.end(), from);
+	const auto last = std::lower_bound(first, timeStamps.end(), std::max(from, to));
+	return { static_cast<uint32_t>(first - timeStamps.begin()), static_cast<uint32_t>(last - timeStamps.begin()) };
+}
+
+int64_t LogHolder::GetFilteredRowForTime(int64_t time) const
+{
+	const auto shown = filteredLogEntries;
+	if (shown->empty()) return -1;
+	if (timeSorted)
+	{ // The shown entries are in log order and with that in time order too
+		const auto it = std::lower_bound(shown->begin(), shown->end(), time, [this](const LogEntry* entry, int64_t value) { return GetTimeStamp(entry) < value; });
+		return it == shown->end() ? static_cast<int64_t>(shown->size()) - 1 : it - shown->begin();
+	}
+
+	// Walk the entries in time order, starting at the first one at or after the time, until one of them is shown
+	auto it = std::lower_bound(timeOrder.begin(), timeOrder.end(), time, [this](uint32_t index, int64_t value) { return timeStamps[index] < value; });
+	for (; it != timeOrder.end(); ++it)
+	{
+		const auto row = std::lower_bound(shown->begin(), shown->end(), &logEntries[*it]);
+		if (row != shown->end() && *row == &logEntries[*it]) return row - shown->begin();
 	}
-	return result;
+	return static_cast<int64_t>(shown->size()) - 1;
 }
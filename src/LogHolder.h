@@ -19,8 +19,20 @@
 
 #include "LogEntry.h"
 #include "FormatedStringCache.h"
+#include "TrigramIndex.h"
+#include "LogFilter.h"
+#include "RoaringBitmap.h"
+#include "ZoneMap.h"
+#include "TemplateMiner.h"
+#include "MessageStore.h"
 #include <QString>
 #include <QFile>
+#include <QFuture>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
 
 class LogParser;
 class LogProfile;
@@ -30,12 +42,62 @@ class LogHolder final
     static constexpr QStringView EMPTY_MESSAGE = u"";
 
     std::vector<LogEntry> logEntries;
-    std::vector<const LogEntry*> filteredLogEntries;
+	// Replaced as a whole on every filter change, allowing background tasks to keep working on a consistent snapshot
+	std::shared_ptr<const std::vector<const LogEntry*>> filteredLogEntries = std::make_shared<std::vector<const LogEntry*>>();
+	// Entries matching the current filter, the shown entries additionally contain the context around them
+	std::shared_ptr<const std::vector<const LogEntry*>> filterHits = filteredLogEntries;
+	size_t contextBefore = 0, contextAfter = 0;
+	// Shown rows standing for a run of consecutive repeated entries, only filled while runs get collapsed
+	std::vector<uint32_t> runLengths;
+	std::unordered_set<const LogEntry*> expandedRuns;
+	// One bit per entry index, multi-line entries are folded unless their bit is set
+	std::vector<uint64_t> unfoldedEntries;
+	struct FilterState
+	{
+		LogFilter filter;
+		std::shared_ptr<const std::vector<const LogEntry*>> entries;
+		uint64_t loadGeneration;
+	};
+	// Recently applied filters with their results, least recently used first
+	std::deque<FilterState> filterCache;
+	mutable std::mutex filterCacheMutex;
+	// Incremented on every load, results of an earlier load are never reused
+	uint64_t loadGeneration = 0;
+	// Applied filters in the order the user applied them, for back and forward navigation
+	std::vector<LogFilter> filterNavigation;
+	size_t filterNavigationIndex = 0;
+	// Columns indexed by the position of the entry in logEntries, all values are in milliseconds
+	std::vector<int64_t> timeStamps, timeSinceStart, timeSincePrevious;
+	// Logs are almost always in time order, allowing binary searches on the timestamps
+	bool timeSorted = true;
+	// Entry indices ordered by their timestamp, only built if the log is not in time order
+	std::vector<uint32_t> timeOrder;
+	// Index into the used log levels (NO_LEVEL if the entry has none) and interned thread and sub system names
+	std::vector<uint16_t> levelIds;
+	std::vector<uint32_t> threadIds, subSystemIds;
+	std::vector<QString> threadNames, subSystemNames;
+	// The entries having each level, thread and sub system id, indexed by the id
+	std::vector<RoaringBitmap> levelBitmaps, threadBitmaps, subSystemBitmaps;
+	ZoneMap zoneMap;
+	// Message template of every entry, mined while preprocessing
+	TemplateMiner templateMiner;
+	std::vector<uint32_t> templateIds;
+	// The messages of compressed logs are only kept here, not in the entries
+	MessageStore messageStore;
+	bool compressMessages = false;
     QString systemInfo;
+	uint64_t droppedEntryCount = 0;
 	std::shared_ptr<LogProfile> logProfile;
 	std::vector<std::shared_ptr<LogLevel>> usedLogProfiles;
+	std::unique_ptr<TrigramIndex> searchIndex;
+	QFuture<void> indexingTask;
 
 public:
+	static constexpr uint16_t NO_LEVEL = UINT16_MAX;
+
+	// Which consecutive shown entries get collapsed into a single row
+	enum RepeatCollapse { NO_COLLAPSE, SAME_MESSAGE, SAME_TEMPLATE };
+
     LogHolder() = default;
 
     LogHolder(const std::string& filePath)
@@ -48,34 +110,74 @@ public:
         Load(file);
     }
 
-    ~LogHolder() = default;
+    ~LogHolder();
 
     void Load(const std::string& filePath);
 
-    void Load(QFile* file);
+	// Entries not matching the ingest filter are dropped while parsing and never stored
+    void Load(QFile* file, const LogFilter& ingestFilter = LogFilter());
 
-    void Load(const QString& log);
+    void Load(const QString& log, const LogFilter& ingestFilter = LogFilter());
 
+	// Number of entries the ingest filter of the last load dropped
+	[[nodiscard]] inline uint64_t GetDroppedEntryCount() const { return droppedEntryCount; }
+
+	// The filter function gets called from several threads at once
     void Filter(const std::function<bool(const LogEntry&)>& filterFunction);
 
+	/**
+	 * Applies the filter, deriving the result from a recent one where possible:
+	 * a filter that adds restrictions to a previous one only tests the entries that one showed,
+	 * a filter that drops restrictions only tests the entries that one hid.
+	 */
+	void Filter(const LogFilter& filter);
+
+	/**
+	 * Evaluates the filter without showing the result, so it can run on a worker thread.
+	 * Returns nullptr if it got cancelled.
+	 */
+	[[nodiscard]] std::shared_ptr<const std::vector<const LogEntry*>> EvaluateFilter(const LogFilter& filter, const std::atomic_bool* cancelled = nullptr) const;
+
+	// Shows the result of EvaluateFilter, has to be called on the thread that reads the filtered entries
+	void SetFilterResult(const LogFilter& filter, std::shared_ptr<const std::vector<const LogEntry*>> entries);
+
+	// The cached result of an equivalent filter, nullptr if there is none
+	[[nodiscard]] std::shared_ptr<const std::vector<const LogEntry*>> GetCachedFilterResult(const LogFilter& filter) const;
+
+	struct FilterCacheInfo
+	{
+		size_t results, memoryUsage, memoryLimit;
+	};
+
+	[[nodiscard]] FilterCacheInfo GetFilterCacheInfo() const;
+
+	[[nodiscard]] bool CanGoBackInFilters() const { return filterNavigationIndex > 0; }
+
+	[[nodiscard]] bool CanGoForwardInFilters() const { return filterNavigationIndex + 1 < filterNavigation.size(); }
+
+	// Steps through the applied filters and returns the one to apply, applying it doesn't alter the navigation
+	[[nodiscard]] LogFilter GoBackInFilters() { return filterNavigation[--filterNavigationIndex]; }
+
+	[[nodiscard]] LogFilter GoForwardInFilters() { return filterNavigation[++filterNavigationIndex]; }
+
     [[nodiscard]] size_t GetFilteredLineCount() const
     {
         //TODO handle multi line messages
-        return filteredLogEntries.size();
+        return filteredLogEntries->size();
     }
 
     [[nodiscard]] QStringView GetFilteredLineNumber(int editorLineNumber) const
     {
         //TODO handle multi line messages
-        if (editorLineNumber >= filteredLogEntries.size()) return EMPTY_MESSAGE;
-        return FormattedStringCache::NumberAsString(filteredLogEntries[editorLineNumber]->lineNumber);
+        if (editorLineNumber >= filteredLogEntries->size()) return EMPTY_MESSAGE;
+        return FormattedStringCache::NumberAsString((*filteredLogEntries)[editorLineNumber]->lineNumber);
     }
 
     [[nodiscard]] QStringView GetFilteredEntryNumber(int editorLineNumber) const
     {
         //TODO handle multi line messages
-        if (editorLineNumber >= filteredLogEntries.size()) return EMPTY_MESSAGE;
-        return FormattedStringCache::NumberAsString(filteredLogEntries[editorLineNumber]->entryNumber);
+        if (editorLineNumber >= filteredLogEntries->size()) return EMPTY_MESSAGE;
+        return FormattedStringCache::NumberAsString((*filteredLogEntries)[editorLineNumber]->entryNumber);
     }
 
     [[nodiscard]] inline uint64_t GetMaxLineNumber() const
@@ -86,27 +188,191 @@ public:
 
     [[nodiscard]] inline const std::vector<const LogEntry*>& GetFilteredEntries() const
     {
-        return filteredLogEntries;
+        return *filteredLogEntries;
     }
 
+	[[nodiscard]] inline std::shared_ptr<const std::vector<const LogEntry*>> GetFilteredEntriesSnapshot() const
+	{
+		return filteredLogEntries;
+	}
+
+	// Returns the row of the entry in the filtered view, or -1 if the entry is filtered out
+	[[nodiscard]] int64_t GetFilteredRow(const LogEntry* entry) const;
+
+	// Shows the given number of entries before and after every entry matching the filter, like grep -C
+	void SetFilterContext(size_t before, size_t after);
+
+	[[nodiscard]] inline bool HasFilterContext() const { return contextBefore != 0 || contextAfter != 0; }
+
+	[[nodiscard]] inline size_t GetFilterHitCount() const { return filterHits->size(); }
+
+	// True if the entry in the row of the filtered view doesn't directly follow the one in the row before
+	[[nodiscard]] bool IsFilteredGap(size_t row) const;
+
+	// Templates compare the mined template ids, e.g. for retry loops counting their attempts
+	void SetRepeatCollapse(RepeatCollapse collapse);
+
+	// Number of consecutive entries in the run starting at the row, 1 if it is no run and 0 for the following rows of an expanded run
+	[[nodiscard]] inline uint32_t GetRunLength(size_t row) const { return row < runLengths.size() ? runLengths[row] : 1; }
+
+	[[nodiscard]] inline bool IsMultiLine(const LogEntry* entry) const
+	{
+		return GetMessage(entry).contains(QChar(LogEntry::LINE_BREAK));
+	}
+
+	[[nodiscard]] inline bool IsUnfolded(const LogEntry* entry) const
+	{
+		const size_t index = GetEntryIndex(entry);
+		return (unfoldedEntries[index / 64] >> (index % 64)) & 1;
+	}
+
+	void SetUnfolded(const LogEntry* entry, bool unfolded);
+
+	// Message as shown in the log view: the first line of a folded entry, all lines of an unfolded one
+	[[nodiscard]] QString GetDisplayedMessage(const LogEntry* entry) const;
+
+	[[nodiscard]] inline bool HasCollapsedRuns() const { return !runLengths.empty(); }
+
+	[[nodiscard]] bool IsRunExpanded(size_t row) const;
+
+	// Shows all entries of the run starting at the row, or collapses them again
+	void ToggleRun(size_t row);
+
     [[nodiscard]] inline const QString& GetSystemInfo() const
     {
 	    return systemInfo;
     }
 
-	[[nodiscard]] inline const std::vector<std::shared_ptr<LogLevel>>& GetUsedLogLevels()
+	[[nodiscard]] inline const std::vector<std::shared_ptr<LogLevel>>& GetUsedLogLevels() const
 	{
 		return usedLogProfiles;
 	}
 
 	[[nodiscard]] inline std::shared_ptr<LogProfile> GetLogProfile() const { return logProfile; }
 
-	[[nodiscard]] std::vector<const LogEntry*> Find(const std::function<bool(const LogEntry&)>& searchFilter) const;
+	[[nodiscard]] inline const std::vector<LogEntry>& GetEntries() const { return logEntries; }
+
+	// Keeps the messages of the following loads in compressed blocks, trading some time on every access for memory
+	void SetCompressMessages(bool compress) { compressMessages = compress; }
+
+	[[nodiscard]] inline const MessageStore& GetMessageStore() const { return messageStore; }
+
+	// Entries of compressed logs don't hold their messages, these work for all logs
+	[[nodiscard]] inline QString GetMessage(const LogEntry* entry) const { return messageStore.GetMessage(GetEntryIndex(entry)); }
+
+	[[nodiscard]] inline QString GetOriginalMessage(const LogEntry* entry) const { return messageStore.GetOriginalMessage(GetEntryIndex(entry)); }
+
+	[[nodiscard]] inline QString GetComponent(const LogEntry* entry, LogComponent::Component component) const
+	{
+		return messageStore.GetComponent(GetEntryIndex(entry), component);
+	}
+
+	// The index might still be under construction, entries that are not yet indexed are reported as search candidates
+	[[nodiscard]] inline const TrigramIndex* GetSearchIndex() const { return searchIndex.get(); }
+
+	// Indexes entries that have been added since the last update in the background
+	void UpdateSearchIndex();
+
+	// Returns the entry the line of the log file belongs to, or null if the log is empty
+	[[nodiscard]] const LogEntry* GetEntryForLine(uint64_t lineNumber) const;
+
+	[[nodiscard]] inline size_t GetEntryIndex(const LogEntry* entry) const
+	{
+		return entry - logEntries.data();
+	}
+
+	// Milliseconds since epoch, entries without a timestamp report the one of their predecessor
+	[[nodiscard]] inline int64_t GetTimeStamp(const LogEntry* entry) const
+	{
+		return timeStamps[GetEntryIndex(entry)];
+	}
+
+	[[nodiscard]] inline std::chrono::milliseconds GetTimeSinceStart(const LogEntry* entry) const
+	{
+		return std::chrono::milliseconds(timeSinceStart[GetEntryIndex(entry)]);
+	}
+
+	[[nodiscard]] inline std::chrono::milliseconds GetTimeSincePrevious(const LogEntry* entry) const
+	{
+		return std::chrono::milliseconds(timeSincePrevious[GetEntryIndex(entry)]);
+	}
+
+	[[nodiscard]] inline const std::vector<int64_t>& GetTimeStampColumn() const { return timeStamps; }
+
+	[[nodiscard]] inline const std::vector<int64_t>& GetTimeSinceStartColumn() const { return timeSinceStart; }
+
+	[[nodiscard]] inline const std::vector<int64_t>& GetTimeSincePreviousColumn() const { return timeSincePrevious; }
+
+	[[nodiscard]] inline bool IsTimeSorted() const { return timeSorted; }
+
+	// Milliseconds since epoch of a date time, or of milliseconds since midnight on the day the log starts
+	[[nodiscard]] int64_t ResolveTime(const QDateTime& dateTime, int time, bool timeOfDay) const;
+
+	// Indices [first, last) of the entries with a timestamp in [from, to), the whole log if it is not in time order
+	[[nodiscard]] std::pair<uint32_t, uint32_t> GetEntryRangeForTime(int64_t from, int64_t to) const;
+
+	// Row of the first shown entry at or after the time, the last row if all of them are earlier and -1 if nothing is shown
+	[[nodiscard]] int64_t GetFilteredRowForTime(int64_t time) const;
+
+	[[nodiscard]] inline const std::vector<uint16_t>& GetLevelColumn() const { return levelIds; }
+
+	[[nodiscard]] inline const std::vector<uint32_t>& GetThreadColumn() const { return threadIds; }
+
+	[[nodiscard]] inline const std::vector<uint32_t>& GetSubSystemColumn() const { return subSystemIds; }
+
+	// Distinct values of the thread and sub system columns, indexed by their id
+	[[nodiscard]] inline const std::vector<QString>& GetThreadNames() const { return threadNames; }
+
+	[[nodiscard]] inline const std::vector<QString>& GetSubSystemNames() const { return subSystemNames; }
+
+	[[nodiscard]] inline const std::vector<RoaringBitmap>& GetLevelBitmaps() const { return levelBitmaps; }
+
+	[[nodiscard]] inline const std::vector<RoaringBitmap>& GetThreadBitmaps() const { return threadBitmaps; }
+
+	[[nodiscard]] inline const std::vector<RoaringBitmap>& GetSubSystemBitmaps() const { return subSystemBitmaps; }
+
+	[[nodiscard]] inline const ZoneMap& GetZoneMap() const { return zoneMap; }
+
+	[[nodiscard]] inline const TemplateMiner& GetTemplateMiner() const { return templateMiner; }
+
+	[[nodiscard]] inline const std::vector<uint32_t>& GetTemplateColumn() const { return templateIds; }
+
+	[[nodiscard]] inline uint32_t GetTemplateId(const LogEntry* entry) const { return templateIds[GetEntryIndex(entry)]; }
+
+	// Number of entries per template id
+	[[nodiscard]] std::vector<uint64_t> CountTemplates(const std::vector<const LogEntry*>& entries) const;
+
+	// Results are in log order, the search function gets called from several threads at once
+	// Entries of compressed logs don't hold their messages, the function has to read them with GetMessage
+	// Chunks of the log whose messages can't contain all required literals (lower case) are skipped
+	[[nodiscard]] std::vector<const LogEntry*> Find(const std::function<bool(const LogEntry&)>& searchFilter, const QStringList& requiredLiterals = {}) const;
 
 	[[nodiscard]] std::vector<const LogEntry*> FindFiltered(const std::function<bool(const LogEntry&)>& searchFilter) const;
 
 private:
+	RepeatCollapse repeatCollapse = NO_COLLAPSE;
+
     void Load(LogParser& parser);
 
     void PreprocessLogEntries();
+
+	void StopIndexing();
+
+	[[nodiscard]] size_t GetFilterCacheMemoryUsage() const;
+
+	void AddToFilterNavigation(const LogFilter& filter);
+
+	// Rebuilds the shown entries from the filter hits: adds the context and collapses repeated entries
+	void UpdateShownEntries();
+
+	// Merges the context ranges around the ascending hits in a single pass
+	[[nodiscard]] std::shared_ptr<const std::vector<const LogEntry*>> ExpandToContext(const std::shared_ptr<const std::vector<const LogEntry*>>& hits) const;
+
+	// Groups neighbouring entries with equal messages or template ids in a single pass
+	// Messages are compared as texts only if their hashes are equal
+	[[nodiscard]] std::shared_ptr<const std::vector<const LogEntry*>> CollapseRuns(const std::shared_ptr<const std::vector<const LogEntry*>>& entries);
+
+	[[nodiscard]] std::vector<const LogEntry*> Refine(const std::vector<const LogEntry*>& shown, const std::vector<const FilterNode*>& addedRestrictions, const std::atomic_bool* cancelled) const;
+
+	[[nodiscard]] std::vector<const LogEntry*> Widen(const std::vector<const LogEntry*>& shown, const LogFilter& filter, const std::atomic_bool* cancelled) const;
 };
\ No newline at end of file
@@ -24,11 +24,11 @@
 class LogLevelAreaWidget : public EditInfoAreaWidget
 {
 	const LogLevel fallbackLogLevel;
-	const std::vector<const LogEntry*>* logEntries;
+	const LogHolder* logHolder;
 public:
 	LogLevelAreaWidget(InfoAreaEnabledPlainTextEdit* editor, int marginLeft = 5, int marginRight = 5)
         : EditInfoAreaWidget(editor, [this](auto && lnr) { return GetMetaDescriptionForLine(std::forward<decltype(lnr)>(lnr)); }, marginLeft, marginRight)
-		, logEntries(nullptr)
+		, logHolder(nullptr)
     {
         SetBackgroundColor(Qt::lightGray);
     }
@@ -38,9 +38,9 @@ public:
         return '#';
     }
 
-	void SetLogHolder(const std::vector<const LogEntry*>* logEntries, const std::vector<std::shared_ptr<LogLevel>>& usedLevels)
+	void SetLogHolder(const LogHolder* holder, const std::vector<std::shared_ptr<LogLevel>>& usedLevels)
 	{
-		this->logEntries = logEntries;
+		logHolder = holder;
 		int maxChars = 0;
 		for(const auto& level : usedLevels)
 		{
@@ -51,7 +51,7 @@ public:
 
     EditInfoAreaWidgetMetaDescription GetMetaDescriptionForLine(int lineNr)
     {
-		if (!logEntries || logEntries->size() <= lineNr)
+		if (!logHolder || logHolder->GetFilteredEntries().size() <= lineNr)
 		{
 			return {
 				fallbackLogLevel.GetLevelName(),
@@ -60,7 +60,7 @@ public:
 				fallbackLogLevel.GetAlignment()
 				};
 		}
-        LogLevel* level = (*logEntries)[lineNr]->level.get();
+        LogLevel* level = logHolder->GetFilteredEntries()[lineNr]->level.get();
 		return {
 			level->GetLevelName(),
 			level->GetFontColor(),
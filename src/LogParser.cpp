@@ -18,6 +18,7 @@
 #include "LogParser.h"
 #include "AppConfig.h"
 #include "LogProfile.h"
+#include <QDebug>
 #include <QRegularExpression>
 #include <memory>
 
@@ -30,6 +31,12 @@ namespace
 	const QString MATCH_GROUP_MESSAGE = "message";
 	const QString MATCH_GROUP_WHERE = "where";
 	const QString MATCH_GROUP_LEVEL = "level";
+
+	//TODO
+	QDateTime ParseTimeStamp(const QString& date, const QString& time)
+	{
+		return QDateTime::fromString("20" + date + ' ' + time, Qt::ISODateWithMs);
+	}
 }
 
 LogParser::~LogParser()
@@ -79,15 +86,29 @@ std::vector<LogEntry> LogParser::Parse()
 
 	LoadRegexesFromProfile();
 
+	if (ingestFilter.ShowsAll() && !logProfile->GetIngestFilter().isEmpty())
+	{
+		SetIngestFilter(LogFilter(logProfile->GetIngestFilter()));
+	}
+
 	//TODO fill logType with known log types from profile
 
 	QString msg;
 	uint64_t currentLine = 1;
 	while (!(msg = GetNextMessage(*inputStream)).isEmpty())
 	{
-		if (!msg.isEmpty()) entries.push_back(ParseMessage(msg, currentLine));
+		if (ingestFilter.ShowsAll())
+		{
+			entries.push_back(ParseMessage(msg, currentLine));
+		}
+		else
+		{
+			IngestMessage(msg, currentLine, entries);
+		}
 		currentLine = lineNumber;
 	}
+	// Without any timestamp in the log all entries count as time 0, like in the log holder
+	FlushUntimedEntries(entries);
 	if (inputFile)
 	{
 		inputFile->close();
@@ -95,6 +116,88 @@ std::vector<LogEntry> LogParser::Parse()
 	return entries;
 }
 
+void LogParser::SetIngestFilter(const LogFilter& filter)
+{
+	if (!filter.IsValid()) return;
+	if (const QString error = filter.GetIngestError(); !error.isEmpty())
+	{
+		qWarning() << "Ignoring ingest filter" << filter.GetExpression() << ':' << error;
+		return;
+	}
+	ingestFilter = filter;
+	ingestNeedsTime = filter.HasTimeRestriction();
+}
+
+void LogParser::IngestMessage(const QString& message, uint64_t startLineNumber, std::vector<LogEntry>& entries)
+{
+	// Later entries without a timestamp inherit the one of this message, with time restrictions every message needs the regex
+	const bool lacksLiterals = !MayPassIngestFilter(message);
+	if (lacksLiterals && !ingestNeedsTime)
+	{
+		DropMessage(message);
+		return;
+	}
+
+	const auto match = logEntryRegex.match(message);
+	if (ingestNeedsTime && match.hasMatch())
+	{
+		const QDateTime timeStamp = ParseTimeStamp(match.captured(MATCH_GROUP_DATE), match.captured(MATCH_GROUP_TIME));
+		if (timeStamp.isValid())
+		{
+			lastTimeStamp = timeStamp.toMSecsSinceEpoch();
+			if (!foundTimeStamp)
+			{
+				foundTimeStamp = true;
+				FlushUntimedEntries(entries);
+			}
+		}
+	}
+
+	// Level restrictions like "level >= WARN" reject most messages, before any component gets extracted
+	if (lacksLiterals || !ingestFilter.MayShowLevel(match.hasMatch() ? match.captured(MATCH_GROUP_LEVEL) : QString()))
+	{
+		DropMessage(message);
+		return;
+	}
+
+	LogEntry entry = ParseMessage(message, match, startLineNumber);
+	if (ingestNeedsTime && !foundTimeStamp)
+	{ // Entries before the first timestamp get that one, like in the log holder
+		untimedEntries.push_back(std::move(entry));
+		return;
+	}
+	if (ingestFilter.ShowEntry(entry, lastTimeStamp)) entries.push_back(std::move(entry));
+	else droppedEntryCount++;
+}
+
+void LogParser::FlushUntimedEntries(std::vector<LogEntry>& entries)
+{
+	for (LogEntry& entry : untimedEntries)
+	{
+		if (ingestFilter.ShowEntry(entry, lastTimeStamp)) entries.push_back(std::move(entry));
+		else droppedEntryCount++;
+	}
+	untimedEntries.clear();
+}
+
+void LogParser::DropMessage(const QString& message)
+{
+	// Only the system info gets extracted from rejected messages
+	++entryCount;
+	TryExtractEnvironment(message);
+	droppedEntryCount++;
+}
+
+bool LogParser::MayPassIngestFilter(const QString& message) const
+{
+	// Every component is a part of the raw message, so text it lacks can't be in any of them
+	for (const auto& [key, restriction] : ingestFilter.GetConjunction())
+	{
+		if (restriction->type == FilterNode::PATTERN && !restriction->pattern.ContainsRequiredLiterals(message)) return false;
+	}
+	return true;
+}
+
 void LogParser::LoadRegexesFromProfile()
 {
 	logEntryRegex = QRegularExpression(logProfile->GetLogEntryRegex());
@@ -121,7 +224,7 @@ QString LogParser::GetNextMessage(QTextStream& inputStream)
 		}
 		else if (!readAhead.isEmpty())
 		{
-			message += QChar(0x000023CE); //("⏎");
+			message += QChar(LogEntry::LINE_BREAK);
 			message += readAhead;
 		}
 		readAhead = inputStream.readLine();
@@ -137,11 +240,15 @@ QString GetMatchFromRawData(const QRegularExpressionMatch& match, const QString&
 }
 
 LogEntry LogParser::ParseMessage(const QString& message, uint64_t startLineNumber)
+{
+	return ParseMessage(message, logEntryRegex.match(message), startLineNumber);
+}
+
+LogEntry LogParser::ParseMessage(const QString& message, const QRegularExpressionMatch& match, uint64_t startLineNumber)
 {
 	LogEntry e;
 	e.entryNumber = ++entryCount;
 	e.lineNumber = startLineNumber;
-	const auto match = logEntryRegex.match(message);
 	TryExtractEnvironment(message);
 
 	e.components[LogComponent::ORIGINAL_MESSAGE] = message;
@@ -159,8 +266,7 @@ LogEntry LogParser::ParseMessage(const QString& message, uint64_t startLineNumbe
 		const QString type = GetMatchFromRawData(match, MATCH_GROUP_LEVEL);
 		e.level = GetLogLevel(type);
 
-		//TODO
-		e.timeStamp = QDateTime::fromString("20" + e.components[LogComponent::DATE] + ' ' + e.components[LogComponent::TIME], Qt::ISODateWithMs);
+		e.timeStamp = ParseTimeStamp(e.components[LogComponent::DATE], e.components[LogComponent::TIME]);
 	}
 	else
 	{
@@ -228,8 +334,10 @@ std::shared_ptr<LogLevel> LogParser::GetLogLevel(const QString& type)
 	{
 		return logLevelMap[type];
 	}
-	auto level = std::make_shared<LogLevel>(type);
-	logLevelMap.insert(type, level);
+	// The type points into the message it was found in, the level gets its own copy so it doesn't depend on the message
+	const QString name(type.constData(), type.size());
+	auto level = std::make_shared<LogLevel>(name);
+	logLevelMap.insert(name, level);
 	return level;
 }
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <LogEntry.h>
+#include "LogFilter.h"
 #include <QFile>
 #include <QString>
 #include <QTextStream>
@@ -35,12 +36,22 @@ class LogParser final
 
 	uint64_t entryCount = 0;
 	uint64_t lineNumber = 0;
+	uint64_t droppedEntryCount = 0;
 	bool ownsFile = false;
 
 	QMap<QString, std::shared_ptr<LogLevel>> logLevelMap;
 
 	std::shared_ptr<LogProfile> logProfile;
 
+	// Entries not matching it are dropped while parsing
+	LogFilter ingestFilter;
+	bool ingestNeedsTime = false;
+	// Time entries without a timestamp inherit from their predecessor, for the time restrictions of the ingest filter
+	int64_t lastTimeStamp = 0;
+	bool foundTimeStamp = false;
+	// Entries before the first timestamp, they are filtered once it is known
+	std::vector<LogEntry> untimedEntries;
+
 	// Regexes
 	QRegularExpression logEntryRegex;
 	QRegularExpression newLogEntryStart;
@@ -65,6 +76,16 @@ public:
 
 	std::vector<LogEntry> Parse();
 
+	/**
+	 * Only keeps the entries matching the filter, without one the ingest filter of the detected profile is used.
+	 * Messages that can't contain the text the filter requires are dropped before the entry regex runs on them,
+	 * messages whose level is ruled out before their components get extracted.
+	 * Filters that GetIngestError reports as unusable are ignored.
+	 */
+	void SetIngestFilter(const LogFilter& filter);
+
+	[[nodiscard]] uint64_t GetDroppedEntryCount() const { return droppedEntryCount; }
+
 	[[nodiscard]] QString GetSystemInfo() const;
 
 	[[nodiscard]] std::shared_ptr<LogProfile> GetUsedProfile() const { return logProfile; }
@@ -78,6 +99,18 @@ private:
 
 	LogEntry ParseMessage(const QString& message, uint64_t startLineNumber);
 
+	LogEntry ParseMessage(const QString& message, const QRegularExpressionMatch& match, uint64_t startLineNumber);
+
+	// Parses the message only if it might pass the ingest filter and keeps the entry if it does
+	void IngestMessage(const QString& message, uint64_t startLineNumber, std::vector<LogEntry>& entries);
+
+	void FlushUntimedEntries(std::vector<LogEntry>& entries);
+
+	void DropMessage(const QString& message);
+
+	// Whether the raw message contains the literals of all text restrictions of the ingest filter
+	[[nodiscard]] bool MayPassIngestFilter(const QString& message) const;
+
 	bool IsNewLogMessage(const QString& string);
 
 	void FindLogProfile(QTextStream* inputStream);
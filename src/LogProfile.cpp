@@ -22,6 +22,7 @@
 #include "LogFilter.Convert.h"
 #include "YamlConverters.h"
 #include "AppConfig.h"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <QFile>
@@ -63,7 +64,38 @@ bool LogProfile::IsProfile(const QString& logMessageLine, int line) const
 
 void LogProfile::AddFilterPreset(const std::shared_ptr<LogFilter>& filter)
 {
-	filterPresets.push_back(filter);
+	const auto existing = std::find_if(filterPresets.begin(), filterPresets.end(), [&filter](const auto& preset) { return preset->GetName() == filter->GetName(); });
+	if (existing != filterPresets.end()) *existing = filter;
+	else filterPresets.push_back(filter);
+	Save();
+}
+
+void LogProfile::RemoveFilterPreset(const QString& name)
+{
+	filterPresets.erase(std::remove_if(filterPresets.begin(), filterPresets.end(), [&name](const auto& preset) { return preset->GetName() == name; }), filterPresets.end());
+	if (defaultFilterPreset == name) defaultFilterPreset.clear();
+	Save();
+}
+
+std::shared_ptr<LogFilter> LogProfile::GetFilterPreset(const QString& name) const
+{
+	for (const auto& preset : filterPresets)
+	{
+		if (preset->GetName() == name) return preset;
+	}
+	return nullptr;
+}
+
+std::shared_ptr<LogFilter> LogProfile::GetDefaultFilterPreset() const
+{
+	if (defaultFilterPreset.isEmpty()) return nullptr;
+	auto preset = GetFilterPreset(defaultFilterPreset);
+	return preset && preset->IsValid() ? preset : nullptr;
+}
+
+void LogProfile::SetDefaultFilterPreset(const QString& name)
+{
+	defaultFilterPreset = name;
 	Save();
 }
 
@@ -143,6 +175,7 @@ void LogProfile::Load()
 	detectionRegex = QRegularExpression(config["DetectionRegex"].as<QString>(defaultProfile->detectionRegex.pattern()));
 	detectionLinesToCheck = config["DetectionRange"].as<int>(10);
 	filterPresets = config["FilterPresets"].as<decltype(filterPresets)>(decltype(filterPresets)());
+	defaultFilterPreset = config["DefaultFilterPreset"].as<QString>(QString());
 	logLevels = config["LogLevels"].as<decltype(logLevels)>(decltype(logLevels)());
 	profileIcon = config["Icon"].as<decltype(profileIcon)>(decltype(profileIcon)());
 
@@ -152,6 +185,7 @@ void LogProfile::Load()
 	sysInfoDeviceRegex = config["SystemInfo.DeviceRegex"].as<QString>(defaultProfile->GetSystemInfoDeviceRegex());
 	sysInfoOsRegex = config["SystemInfo.OsRegex"].as<QString>(defaultProfile->GetSystemInfoOsRegex());
 	sysInfoLinesToCheck = config["SystemInfo.LinesToCheck"].as<uint32_t>(sysInfoLinesToCheck);
+	ingestFilter = config["Entries.IngestFilter"].as<QString>(QString());
 }
 
 void LogProfile::Save() const
@@ -168,6 +202,7 @@ void LogProfile::Save() const
 	config["DetectionRegex"] = detectionRegex.pattern();
 	config["DetectionRange"] = detectionLinesToCheck;
 	config["FilterPresets"] = filterPresets;
+	if (!defaultFilterPreset.isEmpty()) config["DefaultFilterPreset"] = defaultFilterPreset;
 	config["LogLevels"] = logLevels;
     config["Icon"] = profileIcon;
 
@@ -177,6 +212,7 @@ void LogProfile::Save() const
 	config["SystemInfo.DeviceRegex"] = sysInfoDeviceRegex;
 	config["SystemInfo.OsRegex"] = sysInfoOsRegex;
 	config["SystemInfo.LinesToCheck"] = sysInfoLinesToCheck;
+	if (!ingestFilter.isEmpty()) config["Entries.IngestFilter"] = ingestFilter;
 
 	configWriter << config;
 
@@ -257,6 +293,12 @@ void LogProfile::SetSystemInfoOsRegex(const QString &regex)
 	Save();
 }
 
+void LogProfile::SetIngestFilter(const QString& expression)
+{
+	ingestFilter = expression;
+	Save();
+}
+
 void LogProfile::SetSystemInfoLinesToCheck(uint32_t linesToCheck)
 {
 	sysInfoLinesToCheck = linesToCheck;
@@ -38,6 +38,8 @@ class LogProfile final
 	QIcon profileIcon;
 
 	std::vector<std::shared_ptr<LogFilter>> filterPresets;
+	// Name of the preset applied to every newly opened log of this profile
+	QString defaultFilterPreset;
 	std::vector<std::shared_ptr<LogLevel>> logLevels;
 	std::string filePath;
 
@@ -50,6 +52,9 @@ class LogProfile final
 	QString sysInfoDeviceRegex;
 	QString sysInfoOsRegex;
 
+	// Filter expression applied while parsing, entries not matching it are never loaded
+	QString ingestFilter;
+
 public:
 	LogProfile();
 
@@ -63,7 +68,9 @@ public:
 
 	void Delete();
 
+	// Replaces an existing preset with the same name
 	void AddFilterPreset(const std::shared_ptr<LogFilter>& filter);
+	void RemoveFilterPreset(const QString& name);
 	void AddLogLevel(const std::shared_ptr<LogLevel>& level);
 
 
@@ -94,6 +101,11 @@ public:
 
 	[[nodiscard]] inline const decltype(logLevels)& GetLogLevels() { return logLevels; }
 	[[nodiscard]] inline const std::vector<std::shared_ptr<LogFilter>>& GetFilterPresets() const { return filterPresets; }
+	[[nodiscard]] std::shared_ptr<LogFilter> GetFilterPreset(const QString& name) const;
+	[[nodiscard]] inline const QString& GetDefaultFilterPresetName() const { return defaultFilterPreset; }
+	// Null if no valid preset should be applied on open
+	[[nodiscard]] std::shared_ptr<LogFilter> GetDefaultFilterPreset() const;
+	void SetDefaultFilterPreset(const QString& name);
 
 	void SetLogLevels(const std::vector<std::shared_ptr<LogLevel>>& levels);
 
@@ -102,6 +114,7 @@ public:
 	[[nodiscard]] inline const QString& GetSystemInfoVersionRegex() const { return sysInfoVersionRegex; }
 	[[nodiscard]] inline const QString& GetSystemInfoDeviceRegex() const { return sysInfoDeviceRegex; }
 	[[nodiscard]] inline const QString& GetSystemInfoOsRegex() const { return sysInfoOsRegex; }
+	[[nodiscard]] inline const QString& GetIngestFilter() const { return ingestFilter; }
 
 	void SetDetectionRegex(const QString& newDetectionRegex);
 	void SetLogEntryRegex(const QString& regex);
@@ -109,6 +122,7 @@ public:
 	void SetSystemInfoVersionRegex(const QString& regex);
 	void SetSystemInfoDeviceRegex(const QString& regex);
 	void SetSystemInfoOsRegex(const QString& regex);
+	void SetIngestFilter(const QString& expression);
 
 
 	static QString FilterName(QString name);
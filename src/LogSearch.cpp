@@ -18,51 +18,138 @@
 #include "LogSearch.h"
 
 #include "LogHolder.h"
+#include "SearchKernel.h"
+#include "SearchResultModel.h"
+#include "SearchScan.h"
 #include "Profiler.hpp"
+#include <QtConcurrent>
+#include <algorithm>
 
-LogSearch::LogSearch(const LogHolder* logHolderr, QPlainTextEdit* resultTextBox)
+LogSearch::LogSearch(const LogHolder* logHolderr, SearchResultModel* resultModel, QObject* parent)
+	: QObject(parent), logHolder(logHolderr), resultModel(resultModel)
+{}
+
+LogSearch::~LogSearch()
+{
+	Cancel();
+	for (auto& task : runningTasks)
+	{
+		task.waitForFinished();
+	}
+}
+
+void LogSearch::Cancel()
 {
-	logHolder = logHolderr;
-	resultText = resultTextBox;
+	if (currentCancelled)
+	{
+		*currentCancelled = true;
+		currentCancelled.reset();
+	}
+	currentGeneration++;
+	currentSession.reset();
+	runningTasks.removeIf([](const QFuture<void>& task) { return task.isFinished(); });
 }
 
-void LogSearch::search(const QString& tokens, bool regex)
+void LogSearch::UpdateFilter()
 {
+	if (!currentSession) return;
+	BlockProfiler profiler("Update search results for filter");
+	currentSession->UpdateFilter();
+	resultModel->Clear();
+	resultModel->AppendHits(currentSession->GetVisibleHits());
+	emit HitCountChanged(resultModel->rowCount(), true);
+}
+
+void LogSearch::search(const QString& tokens, bool regex, bool matchCase)
+{
+	Cancel();
+	resultModel->Clear();
+
 	if (tokens == nullptr || tokens.isEmpty())
 	{
 		qDebug() << "Empty search, clearing results...";
-		resultText->setPlainText(nullptr);
+		emit HitCountChanged(0, true);
 		return;
 	}
 
 	if (tokens.length() <= SEARCH_LIMIT)
 	{
 		qDebug() << "Search length too short, not filling results yet...";
+		emit HitCountChanged(0, true);
 		return;
 	}
 
-	BlockProfiler profiler("Update search results");
-	QString string;
-
+	SearchPattern pattern(tokens, regex, matchCase);
+	if (!pattern.IsValid())
 	{
-		BlockProfiler buildProfiler("Filter entries");
-		for (const LogEntry* entry : logHolder->GetFilteredEntries())
+		emit SearchFailed(pattern.GetErrorString());
+		return;
+	}
+
+	currentCancelled = std::make_shared<std::atomic_bool>(false);
+	SearchTask task { currentGeneration, pattern, logHolder->GetFilteredEntriesSnapshot(), currentCancelled };
+	emit HitCountChanged(0, false);
+	runningTasks.append(QtConcurrent::run([this, task] { RunSearch(task); }));
+}
+
+void LogSearch::RunSearch(const SearchTask& task)
+{
+	BlockProfiler profiler(QString("Update search results (%1)").arg(SearchKernel::GetInstructionSet()));
+	const SearchPattern& pattern = task.pattern;
+	const std::vector<LogEntry>& entries = logHolder->GetEntries();
+	const auto& filteredEntries = *task.filteredEntries;
+	auto filteredIt = filteredEntries.begin();
+	// The session covers all entries, so changing the filter later doesn't require a new search
+	auto session = std::make_shared<SearchSession>(logHolder);
+	MessageStore::Reader reader(logHolder->GetMessageStore());
+	SearchScan scan(logHolder, pattern, *task.cancelled);
+
+	std::vector<SearchHit> batch;
+	size_t hitCount = 0, batchHits = 0;
+	uint64_t scannedBytes = 0;
+
+	const bool completed = scan.ForEachCandidate([&](const uint32_t entryIndex) {
+		const QString message = reader.GetMessage(entryIndex);
+		scannedBytes += message.size() * sizeof(QChar);
+		const size_t firstHit = session->GetHits().size();
+		pattern.ForEachMatch(message, [&](qsizetype start, qsizetype length) {
+			session->AddHit(entryIndex, static_cast<int>(start), static_cast<int>(length));
+		});
+		if (session->GetHits().size() == firstHit) return;
+
+		filteredIt = std::lower_bound(filteredIt, filteredEntries.end(), &entries[entryIndex]);
+		if (filteredIt == filteredEntries.end() || *filteredIt != &entries[entryIndex]) return;
+
+		batch.insert(batch.end(), session->GetHits().begin() + firstHit, session->GetHits().end());
+		batchHits++;
+		hitCount++;
+
+		if (scan.ShouldPostBatch(batchHits))
 		{
-			if (!entry->components[LogComponent::MESSAGE].contains(tokens))
-			{
-				continue;
-			}
-
-			if (!string.isEmpty())
-			{
-				string.append('\n');
-			}
-			string.append(entry->components[LogComponent::MESSAGE]);
+			AppendResults(task.generation, std::move(batch), hitCount, false);
+			batch = {};
+			batchHits = 0;
 		}
-	}
+	});
 
-	{
-		BlockProfiler setProfiler("Set search results");
-		resultText->setPlainText(string);
-	}
+	if (!completed) return;
+	profiler.SetProcessedBytes(scannedBytes);
+	AppendResults(task.generation, std::move(batch), hitCount, true);
+	QMetaObject::invokeMethod(this, [this, generation = task.generation, filteredEntries = task.filteredEntries, session] {
+		if (generation != currentGeneration) return;
+		currentSession = session;
+		// The filter changed while searching, the streamed results belong to the old one
+		if (filteredEntries != logHolder->GetFilteredEntriesSnapshot()) UpdateFilter();
+		emit SessionReady();
+	}, Qt::QueuedConnection);
+}
+
+void LogSearch::AppendResults(uint64_t generation, std::vector<SearchHit> results, size_t hitCount, bool finished)
+{
+	// Executed on the thread of the result view, results of superseded searches get dropped there
+	QMetaObject::invokeMethod(this, [this, generation, results = std::move(results), hitCount, finished] {
+		if (generation != currentGeneration) return;
+		resultModel->AppendHits(results);
+		emit HitCountChanged(hitCount, finished);
+	}, Qt::QueuedConnection);
 }
@@ -18,23 +18,70 @@
 #pragma once
 
 #include <QString>
+#include <QObject>
+#include <QFuture>
+#include <atomic>
+#include <memory>
 
-#include "InfoAreaEnabledPlainTextEdit.h"
 #include "LogHolder.h"
+#include "SearchPattern.h"
+#include "SearchSession.h"
 
-class LogSearch
+class SearchResultModel;
+
+/**
+ * Runs searches on a worker thread and streams the results into the result model in batches.
+ * Starting a new search cancels the running one, results of cancelled searches are never shown.
+ */
+class LogSearch final : public QObject
 {
+	Q_OBJECT
 
 public:
-	LogSearch(const LogHolder* logHolderr, QPlainTextEdit* resultTextBox);
+	LogSearch(const LogHolder* logHolderr, SearchResultModel* resultModel, QObject* parent = nullptr);
+
+	~LogSearch() override;
+
+	void search(const QString& tokens, bool regex = true, bool matchCase = true);
+
+	void Cancel();
+
+	// Shows the hits of the last search that remain visible with the current filter, without scanning the log again
+	// A running search applies the filter once it completes
+	void UpdateFilter();
+
+	// Returns the session of the last completed search, or null while a search is running
+	[[nodiscard]] const std::shared_ptr<SearchSession>& GetSession() const { return currentSession; }
 
-	~LogSearch();
+	[[nodiscard]] bool IsSearching() const { return currentCancelled != nullptr && !currentSession; }
 
-	void search(const QString& tokens, bool regex = true);
+signals:
+	void HitCountChanged(size_t hitCount, bool finished);
+
+	void SearchFailed(const QString& error);
+
+	void SessionReady();
 
 private:
+	struct SearchTask
+	{
+		uint64_t generation;
+		SearchPattern pattern;
+		std::shared_ptr<const std::vector<const LogEntry*>> filteredEntries;
+		std::shared_ptr<std::atomic_bool> cancelled;
+	};
+
+	void RunSearch(const SearchTask& task);
+
+	void AppendResults(uint64_t generation, std::vector<SearchHit> results, size_t hitCount, bool finished);
+
 	const LogHolder* logHolder;
-	QPlainTextEdit* resultText;
+	SearchResultModel* resultModel;
+
+	uint64_t currentGeneration = 0;
+	std::shared_ptr<std::atomic_bool> currentCancelled;
+	std::shared_ptr<SearchSession> currentSession;
+	QList<QFuture<void>> runningTasks;
 
 	static constexpr int SEARCH_LIMIT = 3;
 };
@@ -0,0 +1,258 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LogTableModel.h"
+#include "Profiler.hpp"
+#include <QBrush>
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+	const QString COLUMN_NAMES[LogTableModel::COLUMN_COUNT] = {
+		"Line", "Level", "Date", "Time", "Thread", "Subsystem", "Message", "Where"
+	};
+
+	constexpr LogComponent::Component COLUMN_COMPONENTS[LogTableModel::COLUMN_COUNT] = {
+		LogComponent::ORIGINAL_MESSAGE, LogComponent::ORIGINAL_MESSAGE, LogComponent::DATE, LogComponent::TIME,
+		LogComponent::THREAD, LogComponent::SUB_SYS, LogComponent::MESSAGE, LogComponent::WHERE
+	};
+}
+
+LogTableModel::LogTableModel(QObject* parent) : QAbstractTableModel(parent)
+{}
+
+void LogTableModel::SetLogHolder(const LogHolder* holder)
+{
+	beginResetModel();
+	logHolder = holder;
+	SetRowOrder({});
+	sortColumn = -1;
+	endResetModel();
+}
+
+void LogTableModel::Reset()
+{
+	beginResetModel();
+	SetRowOrder({});
+	endResetModel();
+	if (sortColumn >= 0)
+	{
+		sort(sortColumn, sortOrder);
+	}
+}
+
+int LogTableModel::rowCount(const QModelIndex& parent) const
+{
+	if (parent.isValid() || !logHolder) return 0;
+	return static_cast<int>(logHolder->GetFilteredEntries().size());
+}
+
+int LogTableModel::columnCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+const LogEntry* LogTableModel::GetEntry(int row) const
+{
+	if (!logHolder || row < 0) return nullptr;
+	const auto& entries = logHolder->GetFilteredEntries();
+	const size_t index = MapRow(row);
+	return index < entries.size() ? entries[index] : nullptr;
+}
+
+int LogTableModel::GetRowForFilteredIndex(size_t filteredIndex) const
+{
+	if (rowOrder.empty()) return static_cast<int>(filteredIndex);
+	return filteredIndex < rowOfIndex.size() ? static_cast<int>(rowOfIndex[filteredIndex]) : -1;
+}
+
+void LogTableModel::SetRowOrder(std::vector<uint32_t> order)
+{
+	rowOrder = std::move(order);
+	rowOfIndex.resize(rowOrder.size());
+	for (size_t row = 0; row < rowOrder.size(); row++)
+	{
+		rowOfIndex[rowOrder[row]] = static_cast<uint32_t>(row);
+	}
+}
+
+std::vector<uint32_t> LogTableModel::GetLevelSortKeys() const
+{
+	const auto& usedLevels = logHolder->GetUsedLogLevels();
+	const auto& profileLevels = logHolder->GetLogProfile()->GetLogLevels();
+	const auto profilePosition = [&profileLevels](const LogLevel& level) {
+		const auto it = std::find_if(profileLevels.begin(), profileLevels.end(), [&level](const auto& known) {
+			return known->GetLevelName() == level.GetLevelName();
+		});
+		return static_cast<size_t>(it - profileLevels.begin());
+	};
+	std::vector<uint32_t> order(usedLevels.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](uint32_t left, uint32_t right) {
+		const size_t l = profilePosition(*usedLevels[left]), r = profilePosition(*usedLevels[right]);
+		return l != r ? l < r : usedLevels[left]->GetLevelName() < usedLevels[right]->GetLevelName();
+	});
+	// Entries without a level come first
+	std::vector<uint32_t> keys(usedLevels.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		keys[order[i]] = static_cast<uint32_t>(i + 1);
+	}
+	return keys;
+}
+
+QString LogTableModel::GetCellText(const LogEntry* entry, int column) const
+{
+	switch (column)
+	{
+	case LINE:
+		return FormattedStringCache::NumberAsString(entry->lineNumber);
+	case LEVEL:
+		return entry->level ? entry->level->GetLevelName() : QString();
+	default:
+		return logHolder->GetComponent(entry, COLUMN_COMPONENTS[column]);
+	}
+}
+
+QVariant LogTableModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid()) return {};
+	const LogEntry* entry = GetEntry(index.row());
+	if (!entry) return {};
+
+	switch (role)
+	{
+	case Qt::DisplayRole:
+		return GetCellText(entry, index.column());
+	case Qt::ForegroundRole:
+		if (index.column() == LEVEL && entry->level) return QBrush(entry->level->GetFontColor());
+		break;
+	case Qt::BackgroundRole:
+		if (index.column() == LEVEL && entry->level) return QBrush(entry->level->GetBackgroundColor());
+		break;
+	case Qt::TextAlignmentRole:
+		if (index.column() == LINE) return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+		if (index.column() == LEVEL && entry->level) return entry->level->GetAlignment();
+		break;
+	default:
+		break;
+	}
+	return {};
+}
+
+QVariant LogTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= COLUMN_COUNT) return {};
+	return COLUMN_NAMES[section];
+}
+
+void LogTableModel::sort(int column, Qt::SortOrder order)
+{
+	if (!logHolder || column < 0 || column >= COLUMN_COUNT) return;
+	BlockProfiler profiler("Sort log table");
+
+	emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+	sortColumn = column;
+	sortOrder = order;
+
+	// The selection and the current row have to stay on their entries
+	const QModelIndexList oldIndexes = persistentIndexList();
+	std::vector<size_t> oldEntries;
+	oldEntries.reserve(oldIndexes.size());
+	for (const QModelIndex& index : oldIndexes)
+	{
+		oldEntries.push_back(index.isValid() ? MapRow(index.row()) : SIZE_MAX);
+	}
+
+	const auto& entries = logHolder->GetFilteredEntries();
+	std::vector<uint32_t> newOrder;
+	if (column == LINE)
+	{ // Filtered entries are always in log order, no need to sort them
+		if (order == Qt::DescendingOrder)
+		{
+			newOrder.resize(entries.size());
+			std::iota(newOrder.rbegin(), newOrder.rend(), 0);
+		}
+	}
+	else
+	{
+		newOrder.resize(entries.size());
+		std::iota(newOrder.begin(), newOrder.end(), 0);
+		// Keys are read once up front, messages of compressed logs would otherwise be decompressed for every comparison
+		std::vector<QString> keys;
+		std::vector<uint32_t> levelKeys;
+		if (column == LEVEL)
+		{
+			const std::vector<uint32_t> levelSortKeys = GetLevelSortKeys();
+			const auto& levelColumn = logHolder->GetLevelColumn();
+			levelKeys.reserve(entries.size());
+			for (const LogEntry* entry : entries)
+			{
+				const uint16_t level = levelColumn[logHolder->GetEntryIndex(entry)];
+				levelKeys.push_back(level == LogHolder::NO_LEVEL ? 0 : levelSortKeys[level]);
+			}
+		}
+		else
+		{
+			keys.reserve(entries.size());
+			for (const LogEntry* entry : entries)
+			{
+				keys.push_back(logHolder->GetComponent(entry, COLUMN_COMPONENTS[column]));
+			}
+		}
+		const auto less = [&](const uint32_t left, const uint32_t right) -> bool {
+			if (column == LEVEL) return levelKeys[left] < levelKeys[right];
+			return keys[left] < keys[right];
+		};
+		// Stable sort keeps entries with equal keys in log order
+		if (order == Qt::AscendingOrder)
+		{
+			std::stable_sort(newOrder.begin(), newOrder.end(), less);
+		}
+		else
+		{
+			std::stable_sort(newOrder.begin(), newOrder.end(), [&](uint32_t left, uint32_t right) { return less(right, left); });
+		}
+	}
+	SetRowOrder(std::move(newOrder));
+
+	QModelIndexList newIndexes;
+	newIndexes.reserve(oldIndexes.size());
+	for (qsizetype i = 0; i < oldIndexes.size(); i++)
+	{
+		newIndexes.push_back(index(GetRowForFilteredIndex(oldEntries[i]), oldIndexes[i].column()));
+	}
+	changePersistentIndexList(oldIndexes, newIndexes);
+	emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+int LogTableModel::EstimateColumnWidth(int column, const QFontMetrics& metrics, int sampleSize) const
+{
+	int width = metrics.horizontalAdvance(COLUMN_NAMES[column]);
+	const int rows = rowCount();
+	if (rows == 0) return width;
+
+	const int step = std::max(1, rows / std::max(1, sampleSize));
+	for (int row = 0; row < rows; row += step)
+	{
+		width = std::max(width, metrics.horizontalAdvance(GetCellText(GetEntry(row), column)));
+	}
+	// Always include the last row, as it usually holds the largest line number
+	width = std::max(width, metrics.horizontalAdvance(GetCellText(GetEntry(rows - 1), column)));
+	return std::min(width, MAX_ESTIMATED_COLUMN_WIDTH);
+}
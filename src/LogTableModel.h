@@ -0,0 +1,83 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QFontMetrics>
+#include <vector>
+#include "LogHolder.h"
+
+class LogTableModel final : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	enum Column {
+		LINE, LEVEL, DATE, TIME, THREAD, SUB_SYS, MESSAGE, WHERE, COLUMN_COUNT
+	};
+
+	explicit LogTableModel(QObject* parent = nullptr);
+
+	~LogTableModel() override = default;
+
+	void SetLogHolder(const LogHolder* holder);
+
+	// Must be called after the filtered entries of the log holder have been changed
+	void Reset();
+
+	[[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+	[[nodiscard]] int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+	[[nodiscard]] QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+	[[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+	[[nodiscard]] const LogEntry* GetEntry(int row) const;
+
+	// Returns the row of the given filtered entry index, taking the current sort order into account
+	[[nodiscard]] int GetRowForFilteredIndex(size_t filteredIndex) const;
+
+	// Estimates the width needed by a column from an evenly distributed sample of rows instead of measuring every row
+	[[nodiscard]] int EstimateColumnWidth(int column, const QFontMetrics& metrics, int sampleSize = 512) const;
+
+private:
+	[[nodiscard]] size_t MapRow(int row) const
+	{
+		return rowOrder.empty() ? static_cast<size_t>(row) : rowOrder[row];
+	}
+
+	[[nodiscard]] QString GetCellText(const LogEntry* entry, int column) const;
+
+	// Position of every used log level in the profile, levels the profile doesn't know follow by name
+	[[nodiscard]] std::vector<uint32_t> GetLevelSortKeys() const;
+
+	void SetRowOrder(std::vector<uint32_t> order);
+
+	const LogHolder* logHolder = nullptr;
+
+	// Permutation of the filtered entry indexes and its inverse, empty while the view is in log order
+	std::vector<uint32_t> rowOrder, rowOfIndex;
+
+	int sortColumn = -1;
+	Qt::SortOrder sortOrder = Qt::AscendingOrder;
+
+	static constexpr int MAX_ESTIMATED_COLUMN_WIDTH = 800;
+};
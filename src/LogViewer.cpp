@@ -20,10 +20,16 @@
 #include "Profiler.hpp"
 #include "LineNumberAreaWidget.h"
 #include "LogLevelAreaWidget.h"
+#include "TimeDeltaAreaWidget.h"
 #include "AppConfig.h"
 
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPaintEvent>
 #include <QPainter>
 #include <QTextBlock>
+#include <QTextLayout>
 #include <QStringBuilder>
 
 #include <iostream>
@@ -32,6 +38,10 @@ LogViewer::LogViewer(QWidget *parent) : InfoAreaEnabledPlainTextEdit(parent)
 {
     lineNumberArea = new LineNumberAreaWidget(this);
 	logLevelArea = new LogLevelAreaWidget(this);
+	timeSinceStartArea = new TimeDeltaAreaWidget(this, TimeDeltaAreaWidget::SINCE_START);
+	timeSincePreviousArea = new TimeDeltaAreaWidget(this, TimeDeltaAreaWidget::SINCE_PREVIOUS);
+	timeSinceStartArea->hide();
+	timeSincePreviousArea->hide();
 
     //connect(this, &LogViewer::blockCountChanged, this, &LogViewer::SetViewportMargins);
     connect(this, &LogViewer::cursorPositionChanged, this, &LogViewer::HighlightCurrentLine);
@@ -53,24 +63,182 @@ void LogViewer::SetLogHolder(LogHolder* holder)
 	logHolder = holder;
 	UpdateLogView();
     lineNumberArea->SetWidthForMaxNumber(logHolder->GetMaxLineNumber());
-	logLevelArea->SetLogHolder(&logHolder->GetFilteredEntries(), logHolder->GetUsedLogLevels());
+	logLevelArea->SetLogHolder(logHolder, logHolder->GetUsedLogLevels());
+	timeSinceStartArea->SetLogHolder(logHolder);
+	timeSincePreviousArea->SetLogHolder(logHolder);
     AddInfoAreaWidget(lineNumberArea);
 	AddInfoAreaWidget(logLevelArea);
 }
 
+void LogViewer::SetShowTimeSinceStart(bool show)
+{
+	if (show == HasInfoAreaWidget(timeSinceStartArea)) return;
+	if (show)
+	{
+		AddInfoAreaWidget(timeSinceStartArea);
+	}
+	else
+	{
+		RemoveInfoAreaWidget(timeSinceStartArea);
+	}
+}
+
+void LogViewer::SetShowTimeSincePrevious(bool show)
+{
+	if (show == HasInfoAreaWidget(timeSincePreviousArea)) return;
+	if (show)
+	{
+		AddInfoAreaWidget(timeSincePreviousArea);
+	}
+	else
+	{
+		RemoveInfoAreaWidget(timeSincePreviousArea);
+	}
+}
+
+void LogViewer::SelectRange(size_t row, int start, int length)
+{
+	QTextBlock block = document()->findBlockByNumber(static_cast<int>(row));
+	if (!block.isValid()) return;
+	if (start + length >= block.length() && SetRowUnfolded(row, true))
+	{ // The range is in a folded line of the entry
+		block = document()->findBlockByNumber(static_cast<int>(row));
+	}
+	start = std::min(start, block.length() - 1);
+	length = std::min(length, block.length() - 1 - start);
+	QTextCursor cursor(block);
+	cursor.setPosition(block.position() + start);
+	cursor.setPosition(block.position() + start + length, QTextCursor::KeepAnchor);
+	setTextCursor(cursor);
+	centerCursor();
+}
+
+void LogViewer::ToggleFold(size_t row)
+{
+	const auto& entries = logHolder->GetFilteredEntries();
+	if (row < entries.size()) SetRowUnfolded(row, !logHolder->IsUnfolded(entries[row]));
+}
+
+bool LogViewer::SetRowUnfolded(size_t row, bool unfolded)
+{
+	const auto& entries = logHolder->GetFilteredEntries();
+	if (row >= entries.size() || !logHolder->IsMultiLine(entries[row]) || logHolder->IsUnfolded(entries[row]) == unfolded) return false;
+	const QTextBlock block = document()->findBlockByNumber(static_cast<int>(row));
+	if (!block.isValid()) return false;
+	logHolder->SetUnfolded(entries[row], unfolded);
+
+	// Only the text of the row is replaced, the rest of the document stays untouched
+	QTextCursor cursor(block);
+	cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+	cursor.insertText(logHolder->GetDisplayedMessage(entries[row]));
+	return true;
+}
+
+int64_t LogViewer::GoToTime(int64_t time)
+{
+	const int64_t row = logHolder->GetFilteredRowForTime(time);
+	if (row >= 0) SelectRange(row, 0, 0);
+	return row;
+}
+
+void LogViewer::AddContextMenuAction(QAction* action)
+{
+	contextMenuActions.append(action);
+}
+
+void LogViewer::contextMenuEvent(QContextMenuEvent* event)
+{
+	QMenu* menu = createStandardContextMenu(event->pos());
+	if (!contextMenuActions.isEmpty())
+	{
+		menu->addSeparator();
+		menu->addActions(contextMenuActions);
+	}
+	menu->exec(event->globalPos());
+	delete menu;
+}
+
+void LogViewer::paintEvent(QPaintEvent* event)
+{
+	InfoAreaEnabledPlainTextEdit::paintEvent(event);
+	foldMarkers.clear();
+	if (!logHolder) return;
+	const bool separators = logHolder->HasFilterContext(), runs = logHolder->HasCollapsedRuns();
+	const auto& entries = logHolder->GetFilteredEntries();
+
+	// Rows map to entries, so separators and markers are drawn instead of being added to the text
+	QPainter painter(viewport());
+	const QPen separatorPen(palette().color(QPalette::Mid), 1, Qt::DashLine);
+	const QPen runPen(palette().color(QPalette::PlaceholderText));
+	const QPen foldPen(palette().color(QPalette::Link));
+	const QPointF offset = contentOffset();
+	const qreal markerSpacing = fontMetrics().averageCharWidth() * 2;
+	for (QTextBlock block = firstVisibleBlock(); block.isValid(); block = block.next())
+	{
+		const QRectF geometry = blockBoundingGeometry(block).translated(offset);
+		// Markers are collected for the whole viewport, partial repaints must not lose the clickable ones
+		if (geometry.top() > viewport()->rect().bottom()) break;
+		const int row = block.blockNumber();
+		if (separators && logHolder->IsFilteredGap(row))
+		{ // Like the -- between the context ranges of grep
+			painter.setPen(separatorPen);
+			painter.drawLine(QPointF(0, geometry.top()), QPointF(viewport()->width(), geometry.top()));
+		}
+		if (row >= static_cast<int>(entries.size()) || block.layout()->lineCount() == 0) continue;
+		const QTextLine line = block.layout()->lineAt(0);
+		const QPointF origin = QPointF(offset.x(), geometry.top()) + block.layout()->position() + line.position();
+		qreal x = origin.x() + line.naturalTextWidth() + markerSpacing;
+		const qreal baseline = origin.y() + line.ascent();
+		if (logHolder->IsMultiLine(entries[row]))
+		{ // Clicking the marker folds or unfolds the entry
+			const bool unfolded = logHolder->IsUnfolded(entries[row]);
+			const QString text = unfolded ? tr("[-]") : tr("[+%n line(s)]", nullptr, static_cast<int>(logHolder->GetMessage(entries[row]).count(QChar(LogEntry::LINE_BREAK))));
+			const QRectF bounds(x, origin.y(), fontMetrics().horizontalAdvance(text), line.height());
+			painter.setPen(foldPen);
+			painter.drawText(QPointF(x, baseline), text);
+			foldMarkers.emplace_back(row, bounds);
+			x = bounds.right() + markerSpacing;
+		}
+		const uint32_t runLength = runs ? logHolder->GetRunLength(row) : 1;
+		if (runLength > 1)
+		{
+			const QString text = logHolder->IsRunExpanded(row) ? tr("(%1 repeats, expanded)").arg(runLength) : tr("(repeated %1 times)").arg(runLength);
+			painter.setPen(runPen);
+			painter.drawText(QPointF(x, baseline), text);
+		}
+	}
+}
+
+void LogViewer::mousePressEvent(QMouseEvent* event)
+{
+	if (event->button() == Qt::LeftButton)
+	{
+		for (const auto& [row, bounds] : foldMarkers)
+		{
+			if (!bounds.contains(event->position())) continue;
+			ToggleFold(row);
+			event->accept();
+			return;
+		}
+	}
+	InfoAreaEnabledPlainTextEdit::mousePressEvent(event);
+}
+
 void LogViewer::UpdateLogView()
 {
     BlockProfiler profiler("Update log view");
     QString string;
     {
         BlockProfiler buildProfiler("Build log message");
-        for (const LogEntry* entry : logHolder->GetFilteredEntries())
+        const auto& entries = logHolder->GetFilteredEntries();
+        for (size_t i = 0; i < entries.size(); i++)
         {
-			if (!string.isEmpty())
+			// Every shown entry needs its own block, even if its displayed message is empty
+			if (i > 0)
 			{
 				string.append('\n');
 			}
-            string.append(entry->components[LogComponent::MESSAGE]);
+            string.append(logHolder->GetDisplayedMessage(entries[i]));
         }
     }
     {
@@ -25,6 +25,9 @@
 #include "LogHolder.h"
 
 QT_BEGIN_NAMESPACE
+class QAction;
+class QContextMenuEvent;
+class QMouseEvent;
 class QPaintEvent;
 class QResizeEvent;
 class QSize;
@@ -33,6 +36,7 @@ QT_END_NAMESPACE
 
 class LineNumberAreaWidget;
 class LogLevelAreaWidget;
+class TimeDeltaAreaWidget;
 class MetaDataArea;
 
 class LogViewer : public InfoAreaEnabledPlainTextEdit
@@ -44,15 +48,51 @@ public:
     
     void SetLogHolder(LogHolder* holder);
     const LogHolder* GetLogHolder() const { return logHolder; };
-        
-private slots:
-    void HighlightCurrentLine();
 
+    void SetShowTimeSinceStart(bool show);
+
+    void SetShowTimeSincePrevious(bool show);
+
+    // Selects the given char range of a row of the filtered view and scrolls it into view, unfolding the entry if needed
+    void SelectRange(size_t row, int start, int length);
+
+	// Shows all lines of the multi-line entry in the row, or only its first line again
+	void ToggleFold(size_t row);
+
+	// Selects the first shown entry at or after the time (milliseconds since epoch), returns its row or -1 if nothing is shown
+	int64_t GoToTime(int64_t time);
+
+	// Actions listed below the standard entries of the context menu
+	void AddContextMenuAction(QAction* action);
+
+protected:
+	void contextMenuEvent(QContextMenuEvent* event) override;
+
+	// Draws separators between the ranges of a filter with context, fold markers and the lengths of collapsed runs
+	void paintEvent(QPaintEvent* event) override;
+
+	void mousePressEvent(QMouseEvent* event) override;
+
+public slots:
+    // Rebuilds the view from the filtered entries of the log holder
     void UpdateLogView();
+
+private slots:
+    void HighlightCurrentLine();
     
 private:
+	// Replaces the text of the row, returns false if the entry has a single line or already is in that state
+	bool SetRowUnfolded(size_t row, bool unfolded);
+
     LineNumberAreaWidget* lineNumberArea;
 	LogLevelAreaWidget* logLevelArea;
+	TimeDeltaAreaWidget* timeSinceStartArea;
+	TimeDeltaAreaWidget* timeSincePreviousArea;
+
+    LogHolder* logHolder = nullptr;
+
+	QList<QAction*> contextMenuActions;
 
-    LogHolder* logHolder;
+	// Fold markers painted last, with the row they belong to
+	std::vector<std::pair<int, QRectF>> foldMarkers;
 };
@@ -17,46 +17,511 @@
 
 #include "LogViewerTab.h"
 #include "LogViewer.h"
+#include "LogTableModel.h"
+#include "SearchResultModel.h"
 #include "LogParser.h"
 #include "LogProfile.h"
+#include "LogFilter.h"
 #include "AppConfig.h"
 #include "Profiler.hpp"
+#include <QActionGroup>
+#include <QDateTimeEdit>
+#include <QDialog>
+#include <QDialogButtonBox>
 #include <QFile>
 #include <QFileInfo>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QLabel>
+#include <QMenu>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTextBlock>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+#include <algorithm>
 
-LogViewerTab::LogViewerTab(QFile* file, QWidget *parent)
-	: QSplitter(parent), tabToolTip(file->fileName()), fileName(file->fileName())
+LogViewerTab::LogViewerTab(QFile* file, QWidget *parent, const LogFilter& ingestFilter)
+	: QSplitter(parent), tabToolTip(file->fileName()), fileName(file->fileName()), tableModel(new LogTableModel(this)), filterTimer(new QTimer(this))
 {
 	ui.setupUi(this);
+	filterTimer->setSingleShot(true);
+	filterTimer->setInterval(FILTER_DELAY_MS);
+	connect(filterTimer, &QTimer::timeout, this, &LogViewerTab::StartFilter);
 
 	const QFileInfo fileInfo(file->fileName());
 	tabTitle = fileInfo.fileName();
 
-	Load(file);
+	Load(file, ingestFilter);
 
 	// Prevent collapsing the main log view
 	const auto mainView = ui.mainViewSplitter;
 	setCollapsible(this->indexOf(mainView), false);
 	mainView->setCollapsible(mainView->indexOf(ui.logViewer), false);
+	mainView->setCollapsible(mainView->indexOf(ui.logTableView), false);
+
+	InitTableView();
 
 	// Init search
-	search = new LogSearch(ui.logViewer->GetLogHolder(), ui.searchResultsTextEdit);
+	searchResultModel = new SearchResultModel(&logHolder, this);
+	ui.searchResultsView->setModel(searchResultModel);
+	ui.searchResultsView->setItemDelegate(new SearchResultDelegate(searchResultModel, ui.searchResultsView));
+	ui.searchResultsView->setFont(ui.logViewer->font());
+	search = new LogSearch(&logHolder, searchResultModel);
 
 	connect(ui.logViewer, &LogViewer::cursorPositionChanged, this, &LogViewerTab::OnSelectedLineChange);
 	connect(ui.searchTextEdit, &LogViewer::textChanged, this, &LogViewerTab::on_searchTextEdit_textChanged);
+	connect(search, &LogSearch::HitCountChanged, this, &LogViewerTab::OnSearchHitCountChanged);
+	connect(search, &LogSearch::SearchFailed, this, &LogViewerTab::OnSearchFailed);
+	connect(search, &LogSearch::SessionReady, this, &LogViewerTab::OnSearchSessionReady);
+	connect(ui.searchResultsView, &QListView::clicked, this, &LogViewerTab::OnSearchResultActivated);
+	connect(ui.searchResultsView, &QListView::activated, this, &LogViewerTab::OnSearchResultActivated);
+
+	QMenu* presetsMenu = new QMenu(ui.presetsButton);
+	ui.presetsButton->setMenu(presetsMenu);
+	connect(presetsMenu, &QMenu::aboutToShow, this, &LogViewerTab::UpdatePresetsMenu);
+
+	// Time navigation, the shortcuts work anywhere within the tab
+	QAction* goToTimeAction = new QAction(tr("Go to Time..."), this);
+	goToTimeAction->setShortcut(Qt::CTRL | Qt::Key_G);
+	goToTimeAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+	connect(goToTimeAction, &QAction::triggered, this, &LogViewerTab::GoToTime);
+	addAction(goToTimeAction);
+	ui.logViewer->AddContextMenuAction(goToTimeAction);
+	QAction* timeRangeAction = new QAction(tr("Filter Time Range..."), this);
+	timeRangeAction->setShortcut(Qt::CTRL | Qt::SHIFT | Qt::Key_G);
+	timeRangeAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+	connect(timeRangeAction, &QAction::triggered, this, &LogViewerTab::FilterTimeRange);
+	addAction(timeRangeAction);
+	ui.logViewer->AddContextMenuAction(timeRangeAction);
+	QAction* toggleRunAction = new QAction(tr("Expand or Collapse Repeats"), this);
+	toggleRunAction->setShortcut(Qt::CTRL | Qt::Key_E);
+	toggleRunAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+	connect(toggleRunAction, &QAction::triggered, this, &LogViewerTab::ToggleRepeatedRun);
+	addAction(toggleRunAction);
+	ui.logViewer->AddContextMenuAction(toggleRunAction);
+	QAction* toggleFoldAction = new QAction(tr("Fold or Unfold Entry"), this);
+	toggleFoldAction->setShortcut(Qt::CTRL | Qt::SHIFT | Qt::Key_E);
+	toggleFoldAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+	connect(toggleFoldAction, &QAction::triggered, this, &LogViewerTab::ToggleFold);
+	addAction(toggleFoldAction);
+	ui.logViewer->AddContextMenuAction(toggleFoldAction);
+	QAction* hideTemplateAction = new QAction(tr("Hide Message Template"), this);
+	connect(hideTemplateAction, &QAction::triggered, this, &LogViewerTab::HideTemplate);
+	ui.logViewer->AddContextMenuAction(hideTemplateAction);
+	QAction* templatesAction = new QAction(tr("Message Templates..."), this);
+	templatesAction->setShortcut(Qt::CTRL | Qt::SHIFT | Qt::Key_M);
+	templatesAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+	connect(templatesAction, &QAction::triggered, this, &LogViewerTab::ShowTemplates);
+	addAction(templatesAction);
+	ui.logViewer->AddContextMenuAction(templatesAction);
+	if (const auto preset = logHolder.GetLogProfile()->GetDefaultFilterPreset())
+	{
+		ApplyParsedFilter(*preset);
+	}
 }
 
 LogViewerTab::~LogViewerTab()
 {
 	ui.logViewer = nullptr;
-	*search;
+	// The search and filter tasks have to be stopped before the log holder gets destroyed
+	delete search;
+	CancelFilter();
+	for (auto& task : filterTasks)
+	{
+		task.waitForFinished();
+	}
+}
+
+void LogViewerTab::InitTableView()
+{
+	ui.logTableView->hide();
+	ui.logTableView->setModel(tableModel);
+	tableModel->SetLogHolder(&logHolder);
+
+	// Uniform row heights allow the view to only query the visible rows
+	QHeaderView* verticalHeader = ui.logTableView->verticalHeader();
+	verticalHeader->setSectionResizeMode(QHeaderView::Fixed);
+	verticalHeader->setDefaultSectionSize(ui.logTableView->fontMetrics().height() + 4);
+
+	QHeaderView* horizontalHeader = ui.logTableView->horizontalHeader();
+	horizontalHeader->setSectionResizeMode(QHeaderView::Interactive);
+	horizontalHeader->setSortIndicator(LogTableModel::LINE, Qt::AscendingOrder);
+	const QFontMetrics metrics = ui.logTableView->fontMetrics();
+	constexpr int CELL_PADDING = 12;
+	for (int column = 0; column < LogTableModel::COLUMN_COUNT; column++)
+	{
+		horizontalHeader->resizeSection(column, tableModel->EstimateColumnWidth(column, metrics) + CELL_PADDING);
+	}
+
+	connect(ui.logTableView->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &LogViewerTab::OnSelectedTableRowChange);
+}
+
+void LogViewerTab::on_tableViewCheckBox_toggled(bool checked)
+{
+	ui.logTableView->setVisible(checked);
+	ui.logViewer->setVisible(!checked);
+}
+
+void LogViewerTab::on_timeSinceStartCheckBox_toggled(bool checked)
+{
+	ui.logViewer->SetShowTimeSinceStart(checked);
+}
+
+void LogViewerTab::on_timeSincePreviousCheckBox_toggled(bool checked)
+{
+	ui.logViewer->SetShowTimeSincePrevious(checked);
+}
+
+void LogViewerTab::OnSelectedTableRowChange(const QModelIndex& current) const
+{
+	if (const LogEntry* entry = tableModel->GetEntry(current.row()))
+	{
+		ShowLineInFullView(entry->lineNumber);
+	}
+}
+
+void LogViewerTab::on_filterLineEdit_returnPressed()
+{
+	const LogFilter filter(ui.filterLineEdit->text());
+	if (!filter.IsValid())
+	{
+		ui.filterStatusLabel->setText(filter.GetError());
+		ui.filterLineEdit->setStyleSheet("color: red");
+		return;
+	}
+	ui.filterLineEdit->setStyleSheet(QString());
+	filterTimer->stop();
+	pendingFilter = filter;
+	StartFilter();
+}
+
+void LogViewerTab::on_filterLineEdit_textChanged(const QString& text)
+{
+	// Filter while typing, incomplete expressions keep the current filter until they become valid
+	const LogFilter filter(text);
+	if (!filter.IsValid()) return;
+	ui.filterLineEdit->setStyleSheet(QString());
+	RequestFilter(filter);
+}
+
+void LogViewerTab::ApplyParsedFilter(const LogFilter& filter)
+{
+	// The text is only updated for display, it doesn't need to be parsed again
+	const QSignalBlocker blocker(ui.filterLineEdit);
+	ui.filterLineEdit->setText(filter.GetExpression());
+	ui.filterLineEdit->setStyleSheet(QString());
+	filterTimer->stop();
+	pendingFilter = filter;
+	StartFilter();
+}
+
+void LogViewerTab::on_filterBackButton_clicked()
+{
+	if (logHolder.CanGoBackInFilters()) ApplyParsedFilter(logHolder.GoBackInFilters());
+}
+
+void LogViewerTab::on_filterForwardButton_clicked()
+{
+	if (logHolder.CanGoForwardInFilters()) ApplyParsedFilter(logHolder.GoForwardInFilters());
+}
+
+void LogViewerTab::UpdatePresetsMenu()
+{
+	QMenu* menu = ui.presetsButton->menu();
+	menu->clear();
+	const std::shared_ptr<LogProfile> profile = logHolder.GetLogProfile();
+	const auto& presets = profile->GetFilterPresets();
+	for (const auto& preset : presets)
+	{
+		QAction* action = menu->addAction(preset->GetName(), this, [this, preset] { ApplyParsedFilter(*preset); });
+		action->setToolTip(preset->IsValid() ? preset->GetExpression() : preset->GetError());
+		action->setEnabled(preset->IsValid());
+	}
+	if (presets.empty())
+	{
+		menu->addAction(tr("No presets for profile %1").arg(profile->GetProfileName()))->setEnabled(false);
+	}
+	menu->addSeparator();
+	menu->addAction(tr("Save Filter as Preset..."), this, &LogViewerTab::SaveFilterAsPreset)->setEnabled(!profile->IsReadOnly());
+	menu->addAction(tr("Filter Time Range..."), this, &LogViewerTab::FilterTimeRange);
+	menu->addAction(tr("Message Templates..."), this, &LogViewerTab::ShowTemplates);
+
+	QMenu* deleteMenu = menu->addMenu(tr("Delete Preset"));
+	deleteMenu->setEnabled(!profile->IsReadOnly() && !presets.empty());
+	for (const auto& preset : presets)
+	{
+		const QString name = preset->GetName();
+		deleteMenu->addAction(name, this, [this, profile, name] {
+			if (QMessageBox::question(this, tr("Delete Preset"), tr("Delete the filter preset %1?").arg(name)) != QMessageBox::Yes) return;
+			profile->RemoveFilterPreset(name);
+		});
+	}
+
+	QMenu* openMenu = menu->addMenu(tr("Apply on Open"));
+	openMenu->setEnabled(!profile->IsReadOnly());
+	QActionGroup* group = new QActionGroup(openMenu);
+	const auto addOpenAction = [&](const QString& text, const QString& name) {
+		QAction* action = openMenu->addAction(text, this, [profile, name] { profile->SetDefaultFilterPreset(name); });
+		action->setCheckable(true);
+		action->setChecked(profile->GetDefaultFilterPresetName() == name);
+		group->addAction(action);
+	};
+	addOpenAction(tr("None"), QString());
+	for (const auto& preset : presets)
+	{
+		addOpenAction(preset->GetName(), preset->GetName());
+	}
+}
+
+void LogViewerTab::SaveFilterAsPreset()
+{
+	const LogFilter filter(ui.filterLineEdit->text());
+	if (!filter.IsValid() || filter.ShowsAll())
+	{
+		QMessageBox::warning(this, tr("Save Filter as Preset"), filter.IsValid() ? tr("The filter is empty.") : filter.GetError());
+		return;
+	}
+	bool accepted = false;
+	const QString name = QInputDialog::getText(this, tr("Save Filter as Preset"), tr("Preset name:"), QLineEdit::Normal, filter.GetExpression(), &accepted).trimmed();
+	if (!accepted || name.isEmpty()) return;
+	logHolder.GetLogProfile()->AddFilterPreset(std::make_shared<LogFilter>(filter.GetExpression(), name));
+}
+
+void LogViewerTab::RequestFilter(const LogFilter& filter)
+{
+	pendingFilter = filter;
+	filterTimer->start();
+}
+
+void LogViewerTab::CancelFilter()
+{
+	if (filterCancelled)
+	{
+		*filterCancelled = true;
+		filterCancelled.reset();
+	}
+	filterGeneration++;
+	filterTasks.removeIf([](const QFuture<void>& task) { return task.isFinished(); });
+}
+
+void LogViewerTab::StartFilter()
+{
+	CancelFilter();
+	if (auto cached = logHolder.GetCachedFilterResult(pendingFilter))
+	{ // Returning to a recent filter doesn't need a worker
+		ApplyFilterResult(pendingFilter, std::move(cached));
+		return;
+	}
+	filterCancelled = std::make_shared<std::atomic_bool>(false);
+	ui.filterStatusLabel->setText(tr("Filtering..."));
+	filterTasks.append(QtConcurrent::run([this, filter = pendingFilter, generation = filterGeneration, cancelled = filterCancelled] {
+		auto entries = logHolder.EvaluateFilter(filter, cancelled.get());
+		if (!entries) return;
+		// Swapped in on the GUI thread, the views never see a partial or outdated result
+		QMetaObject::invokeMethod(this, [this, filter, generation, entries = std::move(entries)] {
+			if (generation != filterGeneration) return;
+			ApplyFilterResult(filter, entries);
+		}, Qt::QueuedConnection);
+	}));
+}
+
+void LogViewerTab::ApplyFilterResult(const LogFilter& filter, std::shared_ptr<const std::vector<const LogEntry*>> entries)
+{
+	filterCancelled.reset();
+	shownFilter = filter;
+	logHolder.SetFilterResult(filter, std::move(entries));
+	UpdateFilteredViews();
+	ui.filterBackButton->setEnabled(logHolder.CanGoBackInFilters());
+	ui.filterForwardButton->setEnabled(logHolder.CanGoForwardInFilters());
+}
+
+void LogViewerTab::UpdateFilteredViews()
+{
+	ui.logViewer->UpdateLogView();
+	tableModel->Reset();
+	const size_t shown = logHolder.GetFilteredLineCount(), total = logHolder.GetEntries().size();
+	const LogHolder::FilterCacheInfo cache = logHolder.GetFilterCacheInfo();
+	constexpr double MEGABYTE = 1024.0 * 1024.0;
+	const QString cacheInfo = tr("%n cached filter result(s), %1 of %2 MB", nullptr, static_cast<int>(cache.results))
+		.arg(cache.memoryUsage / MEGABYTE, 0, 'f', 1).arg(cache.memoryLimit / MEGABYTE, 0, 'f', 0);
+	QString status = tr("Showing %1 of %2 entries").arg(shown).arg(total);
+	if (logHolder.HasFilterContext()) status += tr(", %n matching", nullptr, static_cast<int>(logHolder.GetFilterHitCount()));
+	if (logHolder.HasCollapsedRuns()) status += tr(", repeats collapsed");
+	ui.filterStatusLabel->setText(shownFilter.ShowsAll() && !logHolder.HasCollapsedRuns() ? cacheInfo : status + '\n' + cacheInfo);
+	// The result list only contains visible entries, the hits of the last search get merged with the new ones
+	search->UpdateFilter();
+}
+
+void LogViewerTab::on_repeatsComboBox_currentIndexChanged(int index)
+{
+	logHolder.SetRepeatCollapse(static_cast<LogHolder::RepeatCollapse>(index));
+	UpdateFilteredViews();
+}
+
+void LogViewerTab::ToggleRepeatedRun()
+{
+	const int row = ui.logViewer->textCursor().blockNumber();
+	if (logHolder.GetRunLength(row) < 2) return;
+	logHolder.ToggleRun(row);
+	UpdateFilteredViews();
+	// Rows before the run don't change, so the run stays selected
+	ui.logViewer->SelectRange(row, 0, 0);
+}
+
+void LogViewerTab::ToggleFold()
+{
+	ui.logViewer->ToggleFold(ui.logViewer->textCursor().blockNumber());
+}
+
+void LogViewerTab::on_contextSpinBox_valueChanged(int value)
+{
+	// Only the context around the current hits changes, the filter doesn't need to be evaluated again
+	logHolder.SetFilterContext(value, value);
+	UpdateFilteredViews();
 }
 
 void LogViewerTab::OnSelectedLineChange() const
 {
 	const auto textCursor = ui.logViewer->textCursor();
 	const auto& entries = logHolder.GetFilteredEntries();
-	const auto lineNumber = entries[std::min(static_cast<size_t>(textCursor.blockNumber()), entries.size() - 1)]->lineNumber;
+	if (entries.empty()) return;
+	ShowLineInFullView(entries[std::min(static_cast<size_t>(textCursor.blockNumber()), entries.size() - 1)]->lineNumber);
+}
+
+void LogViewerTab::GoToTime()
+{
+	const auto& entries = logHolder.GetFilteredEntries();
+	if (entries.empty()) return;
+	// Start out with the time of the selected entry, usually only a part of it needs to be changed
+	const size_t selected = std::min(static_cast<size_t>(ui.logViewer->textCursor().blockNumber()), entries.size() - 1);
+	const QDateTime selectedTime = QDateTime::fromMSecsSinceEpoch(logHolder.GetTimeStamp(entries[selected]));
+	QString text = selectedTime.toString("HH:mm:ss.zzz");
+	QDateTime dateTime;
+	QTime time;
+	bool timeOfDay = false;
+	while (true)
+	{
+		bool accepted = false;
+		text = QInputDialog::getText(this, tr("Go to Time"), tr("Time (HH:mm:ss.zzz or yyyy-MM-dd HH:mm:ss.zzz):"), QLineEdit::Normal, text, &accepted).trimmed();
+		if (!accepted) return;
+		if (FilterParser::ParseTime(text, dateTime, time, timeOfDay)) break;
+		QMessageBox::warning(this, tr("Go to Time"), tr("Invalid time '%1'").arg(text));
+	}
+
+	// A time of day stays on the day of the selected entry, logs spanning several days would jump to the first one otherwise
+	const int64_t timeStamp = timeOfDay ? QDateTime(selectedTime.date(), time).toMSecsSinceEpoch() : dateTime.toMSecsSinceEpoch();
+	const int64_t row = ui.logViewer->GoToTime(timeStamp);
+	if (row >= 0 && ui.logTableView->isVisible())
+	{
+		ui.logTableView->selectRow(tableModel->GetRowForFilteredIndex(row));
+	}
+}
+
+void LogViewerTab::FilterTimeRange()
+{
+	const auto& timeStamps = logHolder.GetTimeStampColumn();
+	if (timeStamps.empty()) return;
+	const auto [first, last] = std::minmax_element(timeStamps.begin(), timeStamps.end());
+	const QString format = "yyyy-MM-dd HH:mm:ss.zzz";
+
+	QDialog dialog(this);
+	dialog.setWindowTitle(tr("Filter Time Range"));
+	QFormLayout* layout = new QFormLayout(&dialog);
+	const auto addTimeEdit = [&dialog, layout, &format](const QString& label, int64_t value) {
+		QDateTimeEdit* edit = new QDateTimeEdit(QDateTime::fromMSecsSinceEpoch(value), &dialog);
+		edit->setDisplayFormat(format);
+		edit->setCalendarPopup(true);
+		layout->addRow(label, edit);
+		return edit;
+	};
+	const QDateTimeEdit* fromEdit = addTimeEdit(tr("From:"), *first);
+	const QDateTimeEdit* toEdit = addTimeEdit(tr("To (inclusive):"), *last);
+	QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+	connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+	layout->addRow(buttons);
+	if (dialog.exec() != QDialog::Accepted) return;
+
+	AddToFilter(QString("time >= \"%1\" and time <= \"%2\"").arg(fromEdit->dateTime().toString(format), toEdit->dateTime().toString(format)));
+}
+
+void LogViewerTab::AddToFilter(const QString& restriction)
+{
+	// The restriction becomes part of the expression, so it can still be edited or saved as a preset
+	const QString expression = ui.filterLineEdit->text().trimmed();
+	ui.filterLineEdit->setText(expression.isEmpty() ? restriction : '(' + expression + ") and " + restriction);
+	on_filterLineEdit_returnPressed();
+}
+
+void LogViewerTab::HideTemplate()
+{
+	const auto& entries = logHolder.GetFilteredEntries();
+	const int row = ui.logViewer->textCursor().blockNumber();
+	if (row < 0 || static_cast<size_t>(row) >= entries.size()) return;
+	AddToFilter(QString("not template = %1").arg(logHolder.GetTemplateId(entries[row])));
+}
+
+void LogViewerTab::ShowTemplates()
+{
+	const TemplateMiner& miner = logHolder.GetTemplateMiner();
+	const std::vector<uint64_t> shownCounts = logHolder.CountTemplates(logHolder.GetFilteredEntries());
+
+	QDialog dialog(this);
+	dialog.setWindowTitle(tr("Message Templates"));
+	dialog.resize(900, 600);
+	QVBoxLayout* layout = new QVBoxLayout(&dialog);
+	layout->addWidget(new QLabel(tr("%n template(s) for %1 entries, %2 KB", nullptr, static_cast<int>(miner.GetTemplateCount()))
+		.arg(logHolder.GetEntries().size()).arg(miner.GetMemoryUsage() / 1024), &dialog));
+
+	QTableWidget* table = new QTableWidget(static_cast<int>(miner.GetTemplateCount()), 4, &dialog);
+	table->setHorizontalHeaderLabels({ tr("Id"), tr("Shown"), tr("Total"), tr("Template") });
+	table->setSelectionBehavior(QAbstractItemView::SelectRows);
+	table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	table->verticalHeader()->hide();
+	table->horizontalHeader()->setStretchLastSection(true);
+	const auto numberItem = [](qulonglong value) {
+		QTableWidgetItem* item = new QTableWidgetItem();
+		item->setData(Qt::DisplayRole, value);
+		return item;
+	};
+	for (uint32_t id = 0; id < miner.GetTemplateCount(); id++)
+	{
+		const int row = static_cast<int>(id);
+		table->setItem(row, 0, numberItem(id));
+		table->setItem(row, 1, numberItem(shownCounts[id]));
+		table->setItem(row, 2, numberItem(miner.GetTemplate(id).count));
+		table->setItem(row, 3, new QTableWidgetItem(miner.GetTemplateText(id)));
+	}
+	// Sorting only after filling, the most frequent templates of the current view first
+	table->setSortingEnabled(true);
+	table->sortItems(1, Qt::DescendingOrder);
+	layout->addWidget(table);
+
+	QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+	const auto addFilterButton = [&](const QString& text, const QString& restriction) {
+		connect(buttons->addButton(text, QDialogButtonBox::ActionRole), &QPushButton::clicked, &dialog, [this, &dialog, table, restriction] {
+			QStringList ids;
+			for (const QModelIndex& index : table->selectionModel()->selectedRows(0))
+			{
+				ids.append(index.data().toString());
+			}
+			if (ids.isEmpty()) return;
+			AddToFilter(restriction.arg(ids.join(", ")));
+			dialog.accept();
+		});
+	};
+	addFilterButton(tr("Hide Selected"), "not template in (%1)");
+	addFilterButton(tr("Show Only Selected"), "template in (%1)");
+	connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+	layout->addWidget(buttons);
+	dialog.exec();
+}
+
+void LogViewerTab::ShowLineInFullView(uint64_t lineNumber) const
+{
 	QTextCursor cursor = ui.fullLogView->textCursor();
 	cursor.movePosition(QTextCursor::Start);
 	if (lineNumber > 0)
@@ -90,7 +555,120 @@ void LogViewerTab::HighlightCurrentLineInFullView() const
 
 void LogViewerTab::on_searchTextEdit_textChanged()
 {
-	search->search(ui.searchTextEdit->toPlainText());
+	pendingFindDirection = 0;
+	search->search(ui.searchTextEdit->toPlainText(), ui.regexCheckBox->isChecked(), ui.matchCaseCheckBox->isChecked());
+}
+
+void LogViewerTab::OnSearchHitCountChanged(size_t hitCount, bool finished)
+{
+	if (finished && hitCount == 0 && ui.searchTextEdit->toPlainText().isEmpty())
+	{
+		ui.searchHitCountLabel->clear();
+		return;
+	}
+	ui.searchHitCountLabel->setText(tr("%1 hits%2").arg(hitCount).arg(finished ? "" : " (searching...)"));
+}
+
+void LogViewerTab::OnSearchFailed(const QString& error)
+{
+	ui.searchHitCountLabel->setText(tr("Invalid regex: %1").arg(error));
+}
+
+void LogViewerTab::on_regexCheckBox_toggled(bool)
+{
+	on_searchTextEdit_textChanged();
+}
+
+void LogViewerTab::on_matchCaseCheckBox_toggled(bool)
+{
+	on_searchTextEdit_textChanged();
+}
+
+void LogViewerTab::on_findNextButton_clicked()
+{
+	FindInLogView(true);
+}
+
+void LogViewerTab::on_findPreviousButton_clicked()
+{
+	FindInLogView(false);
+}
+
+void LogViewerTab::on_findAllButton_clicked()
+{
+	on_searchTextEdit_textChanged();
+}
+
+void LogViewerTab::OnSearchSessionReady()
+{
+	if (pendingFindDirection != 0)
+	{
+		FindInLogView(pendingFindDirection > 0);
+	}
+}
+
+void LogViewerTab::OnSearchResultActivated(const QModelIndex& index)
+{
+	const SearchHit* hit = searchResultModel->GetHit(index.row());
+	if (hit) ShowSearchHit(*hit);
+}
+
+void LogViewerTab::ShowFileLine(uint64_t lineNumber)
+{
+	const LogEntry* entry = logHolder.GetEntryForLine(lineNumber);
+	if (!entry) return;
+	const int64_t row = logHolder.GetFilteredRow(entry);
+	if (row >= 0)
+	{
+		ui.logViewer->SelectRange(row, 0, 0);
+		if (ui.logTableView->isVisible())
+		{
+			ui.logTableView->selectRow(tableModel->GetRowForFilteredIndex(row));
+		}
+	}
+	ShowLineInFullView(lineNumber);
+}
+
+void LogViewerTab::ShowSearchHit(const SearchHit& hit)
+{
+	const LogEntry& entry = logHolder.GetEntries()[hit.entryIndex];
+	const int64_t row = logHolder.GetFilteredRow(&entry);
+	if (row < 0)
+	{
+		ShowLineInFullView(entry.lineNumber);
+		return;
+	}
+	ui.logViewer->SelectRange(row, hit.start, hit.length);
+	if (ui.logTableView->isVisible())
+	{
+		ui.logTableView->selectRow(tableModel->GetRowForFilteredIndex(row));
+	}
+}
+
+void LogViewerTab::FindInLogView(bool forward)
+{
+	const auto& session = search->GetSession();
+	if (!session)
+	{
+		pendingFindDirection = forward ? 1 : -1;
+		if (!search->IsSearching())
+		{
+			on_searchTextEdit_textChanged();
+			pendingFindDirection = forward ? 1 : -1;
+		}
+		return;
+	}
+	pendingFindDirection = 0;
+
+	const QTextCursor cursor = ui.logViewer->textCursor();
+	const QTextBlock block = ui.logViewer->document()->findBlock(cursor.selectionStart());
+	const size_t row = block.blockNumber();
+	const int column = cursor.selectionStart() - block.position();
+	const auto hit = forward ? session->FindNext(row, column) : session->FindPrevious(row, column);
+	if (hit)
+	{
+		ui.logViewer->SelectRange(hit->row, hit->start, hit->length);
+	}
 }
 
 void LogViewerTab::OpenSearchTab()
@@ -99,7 +677,7 @@ void LogViewerTab::OpenSearchTab()
 	ui.searchTextEdit->setFocus();
 }
 
-void LogViewerTab::Load(QFile* file)
+void LogViewerTab::Load(QFile* file, const LogFilter& ingestFilter)
 {
 	if (!file->open(QIODevice::ReadOnly))
 	{
@@ -118,10 +696,22 @@ void LogViewerTab::Load(QFile* file)
 		ui.fullLogView->setPlainText(log);
 	}
 	
-	logHolder.Load(log);
-	logHolder.Filter([](auto) -> bool { return true; }); //TODO
+	logHolder.SetCompressMessages(AppConfig::GetInstance()->UseMessageCompression());
+	logHolder.Load(log, ingestFilter);
+	logHolder.Filter(LogFilter());
 	systemInfo = logHolder.GetSystemInfo();
 	tabIcon = logHolder.GetLogProfile()->GetIcon();
+	if (const uint64_t dropped = logHolder.GetDroppedEntryCount())
+	{
+		ui.filterStatusLabel->setText(tr("%1 entries dropped while loading").arg(dropped));
+		tabToolTip += '\n' + tr("Ingest filter: %1").arg(ingestFilter.ShowsAll() ? logHolder.GetLogProfile()->GetIngestFilter() : ingestFilter.GetExpression());
+	}
+	if (const MessageStore& messages = logHolder.GetMessageStore(); messages.IsCompressed())
+	{
+		constexpr double MEGABYTE = 1024.0 * 1024.0;
+		tabToolTip += '\n' + tr("Messages compressed from %1 MB to %2 MB")
+			.arg(messages.GetUncompressedSize() / MEGABYTE, 0, 'f', 1).arg(messages.GetCompressedSize() / MEGABYTE, 0, 'f', 1);
+	}
 	
 	ui.logViewer->SetLogHolder(&logHolder);
 	
@@ -19,17 +19,25 @@
 
 #include "ui_LogViewerTab.h"
 #include "LogHolder.h"
+#include "LogFilter.h"
+#include <QFuture>
 #include <QIcon>
+#include <QTimer>
+#include <atomic>
+#include <memory>
 #include "LogSearch.h"
 
 class LogViewer;
+class LogTableModel;
+class SearchResultModel;
 
 class LogViewerTab final : public QSplitter
 {
 	Q_OBJECT
 
 public:
-	LogViewerTab(QFile* file, QWidget *parent = nullptr);
+	// Entries not matching the ingest filter are dropped while loading
+	LogViewerTab(QFile* file, QWidget *parent = nullptr, const LogFilter& ingestFilter = LogFilter());
 
 	~LogViewerTab() override;
 
@@ -43,6 +51,14 @@ public:
 
 	[[nodiscard]] inline const QString& GetSystemInfo() const { return systemInfo; }
 
+	[[nodiscard]] inline const LogHolder& GetLogHolder() const { return logHolder; }
+
+	// Selects the hit in the log view, entries that are filtered out are only shown in the full log
+	void ShowSearchHit(const SearchHit& hit);
+
+	// Shows the line of the log file in the full log and selects the entry it belongs to
+	void ShowFileLine(uint64_t lineNumber);
+
 	void on_searchTextEdit_textChanged();
 
 	void OpenSearchTab();
@@ -50,11 +66,97 @@ public:
 private slots:
 	void OnSelectedLineChange() const;
 
+	void OnSelectedTableRowChange(const QModelIndex& current) const;
+
+	void on_filterLineEdit_returnPressed();
+
+	void on_filterLineEdit_textChanged(const QString& text);
+
+	void on_filterBackButton_clicked();
+
+	void on_filterForwardButton_clicked();
+
+	void on_contextSpinBox_valueChanged(int value);
+
+	// Evaluates the pending filter on a worker thread, superseding any filter that is still running
+	void StartFilter();
+
+	// Lists the presets of the log profile, the menu is rebuilt every time it gets shown
+	void UpdatePresetsMenu();
+
+	void SaveFilterAsPreset();
+
+	// Selects the first shown entry at or after a time entered by the user
+	void GoToTime();
+
+	// Adds a time range picked by the user to the filter
+	void FilterTimeRange();
+
+	// Adds a restriction to the filter that hides the message template of the selected entry
+	void HideTemplate();
+
+	// Lists the message templates with their counts, selected ones can be hidden or shown exclusively
+	void ShowTemplates();
+
+	void on_tableViewCheckBox_toggled(bool checked);
+
+	void on_timeSinceStartCheckBox_toggled(bool checked);
+
+	void on_timeSincePreviousCheckBox_toggled(bool checked);
+
+	void on_repeatsComboBox_currentIndexChanged(int index);
+
+	// Expands or collapses the run of repeated entries in the selected row
+	void ToggleRepeatedRun();
+
+	void ToggleFold();
+
+	void OnSearchHitCountChanged(size_t hitCount, bool finished);
+
+	void OnSearchFailed(const QString& error);
+
+	void on_regexCheckBox_toggled(bool checked);
+
+	void on_matchCaseCheckBox_toggled(bool checked);
+
+	void on_findNextButton_clicked();
+
+	void on_findPreviousButton_clicked();
+
+	void on_findAllButton_clicked();
+
+	void OnSearchSessionReady();
+
+	void OnSearchResultActivated(const QModelIndex& index);
+
 private:
-	void Load(QFile* file);
+	void Load(QFile* file, const LogFilter& ingestFilter);
+
+	void InitTableView();
+
+	// Filters the log after a short delay, so quickly changing filters only get evaluated once
+	void RequestFilter(const LogFilter& filter);
+
+	void CancelFilter();
+
+	// Combines the current filter expression with the restriction and applies it
+	void AddToFilter(const QString& restriction);
+
+	// Applies a preset or a filter from the history, without parsing its expression again
+	void ApplyParsedFilter(const LogFilter& filter);
+
+	// Shows a filter result and refreshes everything that shows filtered entries
+	void ApplyFilterResult(const LogFilter& filter, std::shared_ptr<const std::vector<const LogEntry*>> entries);
+
+	void UpdateFilteredViews();
+
+	void ShowLineInFullView(uint64_t lineNumber) const;
 
 	void HighlightCurrentLineInFullView() const;
 
+	// Jumps to the next or previous search hit, starting a search if there is no result for the current query yet
+	void FindInLogView(bool forward);
+
 	Ui::LogViewerTabClass ui;
 
 	QString tabTitle, tabToolTip, fileName, systemInfo;
@@ -64,4 +166,24 @@ private:
 	LogHolder logHolder;
 
 	LogSearch* search;
+
+	SearchResultModel* searchResultModel;
+
+	LogTableModel* tableModel;
+
+	static constexpr int FILTER_DELAY_MS = 150;
+
+	QTimer* filterTimer;
+
+	LogFilter pendingFilter, shownFilter;
+
+	// Results of superseded filters are dropped, even if they finish before getting cancelled
+	uint64_t filterGeneration = 0;
+
+	std::shared_ptr<std::atomic_bool> filterCancelled;
+
+	QList<QFuture<void>> filterTasks;
+
+	// Direction of a find request that waits for the search to complete, 0 if there is none
+	int pendingFindDirection = 0;
 };
@@ -19,9 +19,14 @@
 #include "ui_MainWindow.h"
 #include "LogViewerTab.h"
 #include "SettingsWindow.h"
+#include "GlobalSearchWindow.h"
+#include "FileSearchWindow.h"
 #include "RecentFiles.h"
+#include "LogFilter.h"
 #include <QFileDialog>
 #include <QFile>
+#include <QFileInfo>
+#include <QInputDialog>
 #include <QCoreApplication>
 #include <QMimeData>
 #include <QMessageBox>
@@ -33,6 +38,8 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
 	, settingsWindow(new SettingsWindow(this))
+	, globalSearchWindow(new GlobalSearchWindow(logTabs, this))
+	, fileSearchWindow(new FileSearchWindow(this))
 {
     ui->setupUi(this);
     ui->stackedWidget->setCurrentIndex(0);
@@ -48,7 +55,12 @@ MainWindow::MainWindow(QWidget *parent)
 	connect(ui->tabWidget, &QTabWidget::currentChanged, this, &MainWindow::OnTabCurrentChanged);
 	connect(ui->tabWidget, &QTabWidget::tabCloseRequested, this, &MainWindow::OnTabCloseRequested);
 	connect(ui->actionOpen, &QAction::triggered, this, &MainWindow::OnActionOpenTriggered);
+	connect(ui->actionOpenFiltered, &QAction::triggered, this, &MainWindow::OnActionOpenFilteredTriggered);
 	connect(ui->actionSettings, &QAction::triggered, this, &MainWindow::OnActionSettingsTriggered);
+	connect(ui->actionSearchAllTabs, &QAction::triggered, this, &MainWindow::OnActionSearchAllTabsTriggered);
+	connect(globalSearchWindow, &GlobalSearchWindow::HitActivated, this, &MainWindow::OnGlobalSearchHitActivated);
+	connect(ui->actionSearchInFiles, &QAction::triggered, this, &MainWindow::OnActionSearchInFilesTriggered);
+	connect(fileSearchWindow, &FileSearchWindow::OpenFileRequested, this, &MainWindow::OpenAtLine);
 	connect(ui->actionClearList, &QAction::triggered, [] {RecentFiles::GetInstance().ClearList();});
 	connect(ui->actionQuit, &QAction::triggered, &QCoreApplication::quit);
 	connect(ui->actionAboutQT, &QAction::triggered, &QApplication::aboutQt);
@@ -58,6 +70,7 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    delete globalSearchWindow; // Stops the search before the tabs get destroyed
     ui->tabWidget->clear();
     for(const auto node: logTabs)
         delete node;
@@ -96,11 +109,16 @@ void MainWindow::Open(const QStringList& files)
 }
 
 void MainWindow::Open(const QString& filePath)
+{
+	Open(filePath, LogFilter());
+}
+
+void MainWindow::Open(const QString& filePath, const LogFilter& ingestFilter)
 {
     QFile file(filePath);
 	if (file.exists())
 	{ //TODO run async
-		LogViewerTab* viewerTab = new LogViewerTab(&file, ui->tabWidget);
+		LogViewerTab* viewerTab = new LogViewerTab(&file, ui->tabWidget, ingestFilter);
 		AddTab(viewerTab);
 		RecentFiles::GetInstance().Add(filePath);
 	}
@@ -135,6 +153,7 @@ void MainWindow::OnTabCurrentChanged(int index)
 
 void MainWindow::OnTabCloseRequested(int index)
 {
+	globalSearchWindow->OnTabClosed(logTabs[index]);
 	logTabs[index]->deleteLater();
     logTabs.removeAt(index);
     ui->tabWidget->removeTab(index);
@@ -150,6 +169,31 @@ void MainWindow::OnActionOpenTriggered()
     Open(files);
 }
 
+void MainWindow::OnActionOpenFilteredTriggered()
+{
+	const QStringList files = QFileDialog::getOpenFileNames(this, tr("Open File with Filter"), "./", "Log files (*.log);;Text files (*.txt);;Everything (*)");
+	if (files.isEmpty()) return;
+
+	QString expression;
+	while (true)
+	{
+		bool accepted = false;
+		expression = QInputDialog::getText(this, tr("Ingest Filter"), tr("Only load entries matching:"), QLineEdit::Normal, expression, &accepted);
+		if (!accepted) return;
+		const LogFilter filter(expression);
+		const QString error = filter.IsValid() ? filter.GetIngestError() : filter.GetError();
+		if (error.isEmpty())
+		{
+			for (const QString& file : files)
+			{
+				Open(file, filter);
+			}
+			return;
+		}
+		QMessageBox::warning(this, tr("Invalid filter"), error);
+	}
+}
+
 void MainWindow::OpenSearchTab()
 {
 
@@ -170,3 +214,44 @@ void MainWindow::OnActionSettingsTriggered()
 	}
 }
 
+void MainWindow::OnActionSearchAllTabsTriggered()
+{
+	globalSearchWindow->show();
+	globalSearchWindow->raise();
+	globalSearchWindow->activateWindow();
+}
+
+void MainWindow::OnGlobalSearchHitActivated(LogViewerTab* tab, const SearchHit& hit)
+{
+	if (!logTabs.contains(tab)) return;
+	ui->tabWidget->setCurrentWidget(tab);
+	tab->ShowSearchHit(hit);
+	activateWindow();
+}
+
+void MainWindow::OnActionSearchInFilesTriggered()
+{
+	fileSearchWindow->show();
+	fileSearchWindow->raise();
+	fileSearchWindow->activateWindow();
+}
+
+void MainWindow::OpenAtLine(const QString& file, uint64_t lineNumber)
+{
+	const QString canonicalPath = QFileInfo(file).canonicalFilePath();
+	LogViewerTab* target = nullptr;
+	for (LogViewerTab* tab : logTabs)
+	{
+		if (QFileInfo(tab->GetFileName()).canonicalFilePath() == canonicalPath) target = tab;
+	}
+	if (!target)
+	{
+		const qsizetype tabCount = logTabs.size();
+		Open(file);
+		if (logTabs.size() == tabCount) return;
+		target = logTabs.back();
+	}
+	ui->tabWidget->setCurrentWidget(target);
+	target->ShowFileLine(lineNumber);
+	activateWindow();
+}
@@ -19,9 +19,13 @@
 
 #include <QMainWindow>
 #include <QList>
+#include "SearchSession.h"
 
 class LogViewerTab;
 class SettingsWindow;
+class GlobalSearchWindow;
+class FileSearchWindow;
+class LogFilter;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -40,6 +44,9 @@ public:
 
     void Open(const QString& file);
 
+	// Only loads the entries matching the ingest filter
+	void Open(const QString& file, const LogFilter& ingestFilter);
+
     void AddTab(LogViewerTab* viewerTab);
 
 private slots:
@@ -49,8 +56,18 @@ private slots:
 
     void OnActionOpenTriggered();
 
+	void OnActionOpenFilteredTriggered();
+
 	void OnActionSettingsTriggered();
 
+	void OnActionSearchAllTabsTriggered();
+
+	void OnGlobalSearchHitActivated(LogViewerTab* tab, const SearchHit& hit);
+
+	void OnActionSearchInFilesTriggered();
+
+	void OpenAtLine(const QString& file, uint64_t lineNumber);
+
     void dropEvent(QDropEvent* event) override;
 
     void dragEnterEvent(QDragEnterEvent* event) override;
@@ -61,4 +78,6 @@ private:
     Ui::MainWindow *ui;
     QList<LogViewerTab*> logTabs;
 	SettingsWindow *settingsWindow;
+	GlobalSearchWindow *globalSearchWindow;
+	FileSearchWindow *fileSearchWindow;
 };
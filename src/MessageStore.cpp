@@ -0,0 +1,203 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MessageStore.h"
+#include "Profiler.hpp"
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+	struct PendingBlock
+	{
+		QString text;
+		QByteArray compressed;
+	};
+}
+
+const QChar* MessageStore::Reader::Load(size_t index)
+{
+	if (index < blockBegin || index >= blockEnd)
+	{
+		const uint32_t block = store.GetBlock(index);
+		blockBegin = store.blockStarts[block];
+		blockEnd = block + 1 < store.blockStarts.size() ? store.blockStarts[block + 1] : store.locations.size();
+		text = store.Decompress(block);
+	}
+	return reinterpret_cast<const QChar*>(text.constData()) + store.locations[index].offset;
+}
+
+QString MessageStore::Reader::GetMessage(size_t index)
+{
+	if (!store.compressed) return (*store.entries)[index].components[LogComponent::MESSAGE];
+	const Location& location = store.locations[index];
+	return QString::fromRawData(Load(index) + location.messageStart, location.messageLength);
+}
+
+QString MessageStore::Reader::GetOriginalMessage(size_t index)
+{
+	if (!store.compressed) return (*store.entries)[index].components[LogComponent::ORIGINAL_MESSAGE];
+	return QString::fromRawData(Load(index), store.locations[index].length);
+}
+
+QString MessageStore::Reader::GetComponent(size_t index, LogComponent::Component component)
+{
+	switch (component)
+	{
+	case LogComponent::MESSAGE: return GetMessage(index);
+	case LogComponent::ORIGINAL_MESSAGE: return GetOriginalMessage(index);
+	default: return (*store.entries)[index].components[component];
+	}
+}
+
+void MessageStore::Reference(const std::vector<LogEntry>& logEntries)
+{
+	Clear();
+	entries = &logEntries;
+}
+
+void MessageStore::Compress(std::vector<LogEntry>& logEntries)
+{
+	BlockProfiler profiler("Compress messages");
+	Clear();
+	entries = &logEntries;
+	compressed = true;
+	if (logEntries.empty()) return;
+	locations.resize(logEntries.size());
+	blockStarts.push_back(0);
+
+	// Filled blocks get compressed in parallel batches, keeping only a few uncompressed blocks around at any time
+	const size_t batchSize = std::max(1, QThreadPool::globalInstance()->maxThreadCount()) * 4;
+	std::vector<PendingBlock> pending;
+	const auto compressPending = [this, &pending] {
+		QtConcurrent::blockingMap(pending, [](PendingBlock& block) {
+			block.compressed = qCompress(reinterpret_cast<const uchar*>(block.text.constData()), static_cast<qsizetype>(block.text.size() * sizeof(QChar)), COMPRESSION_LEVEL);
+		});
+		for (PendingBlock& block : pending)
+		{
+			blocks.push_back(std::move(block.compressed));
+		}
+		pending.clear();
+	};
+
+	QString text;
+	text.reserve(BLOCK_SIZE / sizeof(QChar));
+	for (size_t i = 0; i < logEntries.size(); i++)
+	{
+		QString& original = logEntries[i].components[LogComponent::ORIGINAL_MESSAGE];
+		QString& message = logEntries[i].components[LogComponent::MESSAGE];
+		// The parser extracts the message as a view into the original message, which makes storing it separately unnecessary
+		const QChar* originalBegin = original.constData();
+		const QChar* messageBegin = message.constData();
+		const bool partOfOriginal = message.isEmpty() || (std::less_equal<const QChar*>()(originalBegin, messageBegin)
+			&& std::less_equal<const QChar*>()(messageBegin + message.size(), originalBegin + original.size()));
+		const qsizetype length = original.size() + (partOfOriginal ? 0 : message.size());
+
+		if (!text.isEmpty() && (text.size() + length) * static_cast<qsizetype>(sizeof(QChar)) > BLOCK_SIZE)
+		{
+			pending.push_back({ std::move(text), {} });
+			text = QString();
+			text.reserve(BLOCK_SIZE / sizeof(QChar));
+			blockStarts.push_back(static_cast<uint32_t>(i));
+			if (pending.size() >= batchSize) compressPending();
+		}
+
+		Location& location = locations[i];
+		location.offset = static_cast<uint32_t>(text.size());
+		location.length = static_cast<uint32_t>(original.size());
+		location.messageStart = message.isEmpty() ? 0 : static_cast<uint32_t>(partOfOriginal ? messageBegin - originalBegin : original.size());
+		location.messageLength = static_cast<uint32_t>(message.size());
+		text += original;
+		if (!partOfOriginal) text += message;
+		uncompressedSize += length * sizeof(QChar);
+
+		original = QString();
+		message = QString();
+	}
+	pending.push_back({ std::move(text), {} });
+	compressPending();
+	profiler.SetProcessedBytes(uncompressedSize);
+}
+
+void MessageStore::Clear()
+{
+	entries = nullptr;
+	compressed = false;
+	blocks.clear();
+	blockStarts.clear();
+	locations.clear();
+	uncompressedSize = 0;
+	std::lock_guard lock(cacheMutex);
+	cache.clear();
+}
+
+QString MessageStore::GetMessage(size_t index) const
+{
+	if (!compressed) return (*entries)[index].components[LogComponent::MESSAGE];
+	const Location& location = locations[index];
+	const QByteArray block = GetCachedBlock(GetBlock(index));
+	return QString(reinterpret_cast<const QChar*>(block.constData()) + location.offset + location.messageStart, location.messageLength);
+}
+
+QString MessageStore::GetOriginalMessage(size_t index) const
+{
+	if (!compressed) return (*entries)[index].components[LogComponent::ORIGINAL_MESSAGE];
+	const Location& location = locations[index];
+	const QByteArray block = GetCachedBlock(GetBlock(index));
+	return QString(reinterpret_cast<const QChar*>(block.constData()) + location.offset, location.length);
+}
+
+QString MessageStore::GetComponent(size_t index, LogComponent::Component component) const
+{
+	switch (component)
+	{
+	case LogComponent::MESSAGE: return GetMessage(index);
+	case LogComponent::ORIGINAL_MESSAGE: return GetOriginalMessage(index);
+	default: return (*entries)[index].components[component];
+	}
+}
+
+size_t MessageStore::GetCompressedSize() const
+{
+	size_t size = locations.size() * sizeof(Location) + blockStarts.size() * sizeof(uint32_t);
+	for (const QByteArray& block : blocks)
+	{
+		size += block.size();
+	}
+	return size;
+}
+
+uint32_t MessageStore::GetBlock(size_t index) const
+{
+	return static_cast<uint32_t>(std::upper_bound(blockStarts.begin(), blockStarts.end(), index) - blockStarts.begin() - 1);
+}
+
+QByteArray MessageStore::GetCachedBlock(uint32_t block) const
+{
+	std::lock_guard lock(cacheMutex);
+	const auto it = std::find_if(cache.begin(), cache.end(), [block](const auto& cached) { return cached.first == block; });
+	if (it != cache.end())
+	{
+		cache.splice(cache.begin(), cache, it);
+		return it->second;
+	}
+	cache.emplace_front(block, Decompress(block));
+	if (cache.size() > CACHED_BLOCKS) cache.pop_back();
+	return cache.front().second;
+}
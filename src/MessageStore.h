@@ -0,0 +1,114 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "LogEntry.h"
+#include <QByteArray>
+#include <QString>
+#include <list>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * Provides the message components of the entries of a log.
+ * Either serves them straight from the entries or keeps them in compressed blocks of about 64KB,
+ * which typically shrinks log text to a fifth of its size or less. Entries of a compressed log don't hold their messages anymore.
+ */
+class MessageStore final
+{
+public:
+	// Bytes of UTF-16 text per block before compression, longer messages get a block of their own
+	static constexpr qsizetype BLOCK_SIZE = 64 * 1024;
+	// Recently used blocks are kept decompressed, so showing neighbouring entries decompresses a block only once
+	static constexpr size_t CACHED_BLOCKS = 16;
+
+	/**
+	 * Reads messages on a single thread without going through the shared cache,
+	 * decompressing every block it passes once. Meant for scans in log order, e.g. by filters and searches.
+	 */
+	class Reader final
+	{
+		const MessageStore& store;
+		size_t blockBegin = 0, blockEnd = 0;
+		QByteArray text;
+
+		const QChar* Load(size_t index);
+
+	public:
+		explicit Reader(const MessageStore& store) : store(store) {}
+
+		// Returned strings point into the current block and are only valid until the reader moves on to another block
+		[[nodiscard]] QString GetMessage(size_t index);
+
+		[[nodiscard]] QString GetOriginalMessage(size_t index);
+
+		[[nodiscard]] QString GetComponent(size_t index, LogComponent::Component component);
+	};
+
+	// Serves the messages from the entries themselves
+	void Reference(const std::vector<LogEntry>& logEntries);
+
+	// Moves the messages of the entries into compressed blocks, other components must not point into the messages anymore
+	void Compress(std::vector<LogEntry>& logEntries);
+
+	void Clear();
+
+	[[nodiscard]] bool IsCompressed() const { return compressed; }
+
+	[[nodiscard]] size_t GetCount() const { return entries ? entries->size() : 0; }
+
+	// Copies of the texts, so they stay valid when their block gets evicted from the cache
+	[[nodiscard]] QString GetMessage(size_t index) const;
+
+	[[nodiscard]] QString GetOriginalMessage(size_t index) const;
+
+	[[nodiscard]] QString GetComponent(size_t index, LogComponent::Component component) const;
+
+	// Memory used by the compressed blocks and their directory
+	[[nodiscard]] size_t GetCompressedSize() const;
+
+	[[nodiscard]] size_t GetUncompressedSize() const { return uncompressedSize; }
+
+private:
+	// Fastest zlib level, logs compress well even with it and loading stays quick
+	static constexpr int COMPRESSION_LEVEL = 1;
+
+	// Positions in characters, the message is relative to the original message and only stored separately if it isn't part of it
+	struct Location
+	{
+		uint32_t offset, length, messageStart, messageLength;
+	};
+
+	const std::vector<LogEntry>* entries = nullptr;
+	bool compressed = false;
+	std::vector<QByteArray> blocks;
+	// Index of the first entry of every block
+	std::vector<uint32_t> blockStarts;
+	std::vector<Location> locations;
+	size_t uncompressedSize = 0;
+	// Decompressed blocks, most recently used first
+	mutable std::list<std::pair<uint32_t, QByteArray>> cache;
+	mutable std::mutex cacheMutex;
+
+	[[nodiscard]] uint32_t GetBlock(size_t index) const;
+
+	[[nodiscard]] QByteArray Decompress(uint32_t block) const { return qUncompress(blocks[block]); }
+
+	[[nodiscard]] QByteArray GetCachedBlock(uint32_t block) const;
+};
@@ -23,6 +23,7 @@ class BlockProfiler final
 {
 	std::chrono::time_point<std::chrono::high_resolution_clock> start;
 	const QString name;
+	uint64_t processedBytes = 0;
 
 public:
 	BlockProfiler(const QString& name) : name(name)
@@ -30,10 +31,20 @@ public:
 		start = std::chrono::high_resolution_clock::now();
 	}
 
+	// Reports the throughput in addition to the time if set
+	void SetProcessedBytes(uint64_t bytes) { processedBytes = bytes; }
+
 	~BlockProfiler()
 	{
 		const std::chrono::time_point<std::chrono::high_resolution_clock> done = std::chrono::high_resolution_clock::now();
 		const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(done - start);
-		qInfo() << name << " took " << time.count() << " ms";
+		if (processedBytes == 0)
+		{
+			qInfo() << name << " took " << time.count() << " ms";
+			return;
+		}
+		const double seconds = std::chrono::duration<double>(done - start).count();
+		qInfo() << name << " took " << time.count() << " ms for " << processedBytes << " bytes ("
+				<< (seconds > 0 ? processedBytes / seconds / 1e9 : 0.0) << " GB/s)";
 	}
 };
@@ -0,0 +1,307 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RoaringBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	inline unsigned CountTrailingZeros(uint64_t value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+#else
+		return __builtin_ctzll(value);
+#endif
+	}
+
+	inline uint32_t CountBits(uint64_t value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		return static_cast<uint32_t>(__popcnt64(value));
+#else
+		return static_cast<uint32_t>(__builtin_popcountll(value));
+#endif
+	}
+}
+
+bool RoaringBitmap::Container::Contains(uint16_t value) const
+{
+	if (IsBitmap()) return (bits[value >> 6] >> (value & 63)) & 1;
+	return std::binary_search(array.begin(), array.end(), value);
+}
+
+void RoaringBitmap::Container::ToBitmap()
+{
+	if (IsBitmap()) return;
+	bits.assign(BITMAP_WORDS, 0);
+	for (const uint16_t value : array)
+	{
+		bits[value >> 6] |= uint64_t(1) << (value & 63);
+	}
+	array.clear();
+	array.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::Shrink()
+{
+	if (!IsBitmap() || cardinality > ARRAY_LIMIT) return;
+	array.clear();
+	array.reserve(cardinality);
+	for (uint32_t word = 0; word < BITMAP_WORDS; word++)
+	{
+		for (uint64_t remaining = bits[word]; remaining; remaining &= remaining - 1)
+		{
+			array.push_back(static_cast<uint16_t>(word * 64 + CountTrailingZeros(remaining)));
+		}
+	}
+	bits.clear();
+	bits.shrink_to_fit();
+}
+
+RoaringBitmap RoaringBitmap::Range(uint32_t begin, uint32_t end)
+{
+	RoaringBitmap result;
+	for (uint64_t start = begin; start < end;)
+	{
+		const uint64_t base = start & ~uint64_t(0xFFFF);
+		const uint32_t low = static_cast<uint32_t>(start - base);
+		const uint32_t high = static_cast<uint32_t>(std::min<uint64_t>(end, base + 0x10000) - base);
+		Container& container = result.containers.emplace_back();
+		container.key = static_cast<uint16_t>(base >> 16);
+		container.cardinality = high - low;
+		if (container.cardinality <= ARRAY_LIMIT)
+		{
+			container.array.resize(container.cardinality);
+			for (uint32_t i = 0; i < container.cardinality; i++)
+			{
+				container.array[i] = static_cast<uint16_t>(low + i);
+			}
+		}
+		else
+		{
+			container.bits.assign(BITMAP_WORDS, 0);
+			for (uint32_t value = low; value < high;)
+			{
+				if ((value & 63) == 0 && high - value >= 64)
+				{
+					container.bits[value >> 6] = ~uint64_t(0);
+					value += 64;
+				}
+				else
+				{
+					container.bits[value >> 6] |= uint64_t(1) << (value & 63);
+					value++;
+				}
+			}
+		}
+		start = base + high;
+	}
+	return result;
+}
+
+void RoaringBitmap::Add(uint32_t value)
+{
+	const uint16_t key = static_cast<uint16_t>(value >> 16), low = static_cast<uint16_t>(value & 0xFFFF);
+	if (containers.empty() || containers.back().key != key)
+	{
+		containers.emplace_back().key = key;
+	}
+	Container& container = containers.back();
+	if (container.IsBitmap())
+	{
+		uint64_t& word = container.bits[low >> 6];
+		const uint64_t bit = uint64_t(1) << (low & 63);
+		if (word & bit) return;
+		word |= bit;
+	}
+	else
+	{
+		if (!container.array.empty() && container.array.back() >= low) return;
+		container.array.push_back(low);
+	}
+	if (++container.cardinality > ARRAY_LIMIT) container.ToBitmap();
+}
+
+bool RoaringBitmap::Contains(uint32_t value) const
+{
+	const uint16_t key = static_cast<uint16_t>(value >> 16);
+	const auto it = std::lower_bound(containers.begin(), containers.end(), key, [](const Container& container, uint16_t key) { return container.key < key; });
+	return it != containers.end() && it->key == key && it->Contains(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+size_t RoaringBitmap::GetCardinality() const
+{
+	size_t cardinality = 0;
+	for (const Container& container : containers)
+	{
+		cardinality += container.cardinality;
+	}
+	return cardinality;
+}
+
+size_t RoaringBitmap::GetMemoryUsage() const
+{
+	size_t usage = sizeof(RoaringBitmap) + containers.capacity() * sizeof(Container);
+	for (const Container& container : containers)
+	{
+		usage += container.array.capacity() * sizeof(uint16_t) + container.bits.capacity() * sizeof(uint64_t);
+	}
+	return usage;
+}
+
+RoaringBitmap RoaringBitmap::And(const RoaringBitmap& other) const
+{
+	return Combine(other, AND);
+}
+
+RoaringBitmap RoaringBitmap::Or(const RoaringBitmap& other) const
+{
+	return Combine(other, OR);
+}
+
+RoaringBitmap RoaringBitmap::AndNot(const RoaringBitmap& other) const
+{
+	return Combine(other, AND_NOT);
+}
+
+void RoaringBitmap::Extract(uint32_t begin, uint32_t end, std::vector<uint32_t>& result) const
+{
+	if (begin >= end) return;
+	const uint16_t firstKey = static_cast<uint16_t>(begin >> 16), lastKey = static_cast<uint16_t>((end - 1) >> 16);
+	auto it = std::lower_bound(containers.begin(), containers.end(), firstKey, [](const Container& container, uint16_t key) { return container.key < key; });
+	for (; it != containers.end() && it->key <= lastKey; ++it)
+	{
+		const uint32_t base = static_cast<uint32_t>(it->key) << 16;
+		// Bounds of the requested range inside this container, high is inclusive
+		const uint32_t low = it->key == firstKey ? begin & 0xFFFF : 0;
+		const uint32_t high = it->key == lastKey ? (end - 1) & 0xFFFF : 0xFFFF;
+		if (!it->IsBitmap())
+		{
+			for (auto value = std::lower_bound(it->array.begin(), it->array.end(), low); value != it->array.end() && *value <= high; ++value)
+			{
+				result.push_back(base + *value);
+			}
+			continue;
+		}
+		for (uint32_t word = low >> 6; word <= high >> 6; word++)
+		{
+			uint64_t remaining = it->bits[word];
+			if (word == low >> 6) remaining &= ~uint64_t(0) << (low & 63);
+			if (word == high >> 6 && (high & 63) != 63) remaining &= (uint64_t(1) << ((high & 63) + 1)) - 1;
+			for (; remaining; remaining &= remaining - 1)
+			{
+				result.push_back(base + word * 64 + CountTrailingZeros(remaining));
+			}
+		}
+	}
+}
+
+RoaringBitmap RoaringBitmap::Combine(const RoaringBitmap& other, Operation operation) const
+{
+	RoaringBitmap result;
+	auto a = containers.begin(), b = other.containers.begin();
+	while (a != containers.end() || b != other.containers.end())
+	{
+		if (b == other.containers.end() || (a != containers.end() && a->key < b->key))
+		{
+			if (operation != AND) result.containers.push_back(*a);
+			++a;
+		}
+		else if (a == containers.end() || b->key < a->key)
+		{
+			if (operation == OR) result.containers.push_back(*b);
+			++b;
+		}
+		else
+		{
+			Container container = Combine(*a, *b, operation);
+			if (container.cardinality) result.containers.push_back(std::move(container));
+			++a;
+			++b;
+		}
+	}
+	return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::Combine(const Container& a, const Container& b, Operation operation)
+{
+	Container result;
+	result.key = a.key;
+	if (!a.IsBitmap() && !b.IsBitmap())
+	{
+		auto output = std::back_inserter(result.array);
+		switch (operation)
+		{
+		case AND: std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), output); break;
+		case OR: std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), output); break;
+		case AND_NOT: std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), output); break;
+		}
+		result.cardinality = static_cast<uint32_t>(result.array.size());
+		if (result.cardinality > ARRAY_LIMIT) result.ToBitmap();
+		return result;
+	}
+
+	// A sparse array only needs to probe the bitmap for its own values
+	const bool probeA = !a.IsBitmap() && (operation == AND || operation == AND_NOT);
+	const bool probeB = !b.IsBitmap() && operation == AND;
+	if (probeA || probeB)
+	{
+		const Container& sparse = probeA ? a : b;
+		const Container& dense = probeA ? b : a;
+		const bool keep = operation == AND;
+		for (const uint16_t value : sparse.array)
+		{
+			if (dense.Contains(value) == keep) result.array.push_back(value);
+		}
+		result.cardinality = static_cast<uint32_t>(result.array.size());
+		return result;
+	}
+
+	const auto wordsOf = [](const Container& container, std::vector<uint64_t>& buffer) -> const uint64_t* {
+		if (container.IsBitmap()) return container.bits.data();
+		Container copy = container;
+		copy.ToBitmap();
+		buffer = std::move(copy.bits);
+		return buffer.data();
+	};
+	std::vector<uint64_t> bufferA, bufferB;
+	const uint64_t* wordsA = wordsOf(a, bufferA);
+	const uint64_t* wordsB = wordsOf(b, bufferB);
+	result.bits.resize(BITMAP_WORDS);
+	for (uint32_t i = 0; i < BITMAP_WORDS; i++)
+	{
+		uint64_t word = 0;
+		switch (operation)
+		{
+		case AND: word = wordsA[i] & wordsB[i]; break;
+		case OR: word = wordsA[i] | wordsB[i]; break;
+		case AND_NOT: word = wordsA[i] & ~wordsB[i]; break;
+		}
+		result.bits[i] = word;
+		result.cardinality += CountBits(word);
+	}
+	result.Shrink();
+	return result;
+}
@@ -0,0 +1,88 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Compressed set of entry indices in the style of a roaring bitmap.
+ * The 32 bit values are split by their upper 16 bits into containers. A container holds a sorted array of the lower
+ * 16 bits while it is sparse and switches to a plain 65536 bit bitmap once that is smaller, so both rare and frequent
+ * values (an error level vs. the main thread) stay compact and set operations run on whole words.
+ */
+class RoaringBitmap final
+{
+	// Containers with more values than this are stored as bitmap, which is 8KB independent of the content
+	static constexpr uint32_t ARRAY_LIMIT = 4096;
+	static constexpr uint32_t BITMAP_WORDS = 65536 / 64;
+
+	struct Container
+	{
+		uint16_t key = 0;
+		uint32_t cardinality = 0;
+		std::vector<uint16_t> array;
+		std::vector<uint64_t> bits;
+
+		[[nodiscard]] bool IsBitmap() const { return !bits.empty(); }
+
+		[[nodiscard]] bool Contains(uint16_t value) const;
+
+		void ToBitmap();
+
+		// Switches back to an array if that is smaller
+		void Shrink();
+	};
+
+	// Sorted by key, empty containers are never stored
+	std::vector<Container> containers;
+
+public:
+	RoaringBitmap() = default;
+
+	// Bitmap containing every value in [begin, end)
+	[[nodiscard]] static RoaringBitmap Range(uint32_t begin, uint32_t end);
+
+	// Values have to be added in ascending order
+	void Add(uint32_t value);
+
+	[[nodiscard]] bool Contains(uint32_t value) const;
+
+	[[nodiscard]] bool IsEmpty() const { return containers.empty(); }
+
+	[[nodiscard]] size_t GetCardinality() const;
+
+	[[nodiscard]] size_t GetMemoryUsage() const;
+
+	[[nodiscard]] RoaringBitmap And(const RoaringBitmap& other) const;
+
+	[[nodiscard]] RoaringBitmap Or(const RoaringBitmap& other) const;
+
+	[[nodiscard]] RoaringBitmap AndNot(const RoaringBitmap& other) const;
+
+	// Appends all values in [begin, end) in ascending order
+	void Extract(uint32_t begin, uint32_t end, std::vector<uint32_t>& result) const;
+
+private:
+	enum Operation { AND, OR, AND_NOT };
+
+	[[nodiscard]] RoaringBitmap Combine(const RoaringBitmap& other, Operation operation) const;
+
+	[[nodiscard]] static Container Combine(const Container& a, const Container& b, Operation operation);
+};
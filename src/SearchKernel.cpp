@@ -0,0 +1,312 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SearchKernel.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SEARCH_KERNEL_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX2 gets compiled through target attributes and selected at runtime
+#define SEARCH_KERNEL_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define SEARCH_KERNEL_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	inline unsigned CountTrailingZeros(uint64_t value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+#else
+		return __builtin_ctzll(value);
+#endif
+	}
+
+	template<typename Char>
+	inline Char FoldAscii(Char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<Char>(c | 0x20) : c;
+	}
+
+	template<typename Char>
+	inline Char UpperAscii(Char c)
+	{
+		return (c >= 'a' && c <= 'z') ? static_cast<Char>(c & ~0x20) : c;
+	}
+
+	template<typename Char>
+	inline bool Equals(const Char* text, const Char* needle, size_t length, bool ignoreAsciiCase)
+	{
+		if (!ignoreAsciiCase) return std::memcmp(text, needle, length * sizeof(Char)) == 0;
+		for (size_t i = 0; i < length; i++)
+		{
+			if (FoldAscii(text[i]) != needle[i]) return false;
+		}
+		return true;
+	}
+
+	template<typename Char>
+	ptrdiff_t FindScalar(const Char* text, size_t textLength, const Char* needle, size_t needleLength, bool ignoreAsciiCase, size_t start)
+	{
+		const Char first = needle[0];
+		for (size_t i = start; i + needleLength <= textLength; i++)
+		{
+			const Char c = ignoreAsciiCase ? FoldAscii(text[i]) : text[i];
+			if (c == first && Equals(text + i + 1, needle + 1, needleLength - 1, ignoreAsciiCase)) return static_cast<ptrdiff_t>(i);
+		}
+		return -1;
+	}
+
+	/**
+	 * Generic first and last char filter, the vector traits provide the register operations.
+	 * MoveMask returns MASK_BITS bits per lane, so the lane of a set bit is its index divided by MASK_BITS.
+	 */
+	template<typename V, typename Char>
+	ptrdiff_t FindVectorised(const Char* text, size_t textLength, const Char* needle, size_t needleLength, bool ignoreAsciiCase)
+	{
+		const size_t positions = textLength - needleLength + 1;
+		const Char first = needle[0], last = needle[needleLength - 1];
+		const auto firstLower = V::Broadcast(first), lastLower = V::Broadcast(last);
+		const auto firstUpper = V::Broadcast(ignoreAsciiCase ? UpperAscii(first) : first);
+		const auto lastUpper = V::Broadcast(ignoreAsciiCase ? UpperAscii(last) : last);
+
+		size_t i = 0;
+		for (; i + V::LANES <= positions; i += V::LANES)
+		{
+			const auto blockFirst = V::Load(text + i);
+			const auto blockLast = V::Load(text + i + needleLength - 1);
+			const auto eqFirst = V::Or(V::Equal(blockFirst, firstLower), V::Equal(blockFirst, firstUpper));
+			const auto eqLast = V::Or(V::Equal(blockLast, lastLower), V::Equal(blockLast, lastUpper));
+			uint64_t mask = V::MoveMask(V::And(eqFirst, eqLast));
+			while (mask)
+			{
+				const unsigned lane = CountTrailingZeros(mask) / V::MASK_BITS;
+				const size_t position = i + lane;
+				if (Equals(text + position + 1, needle + 1, needleLength - 1, ignoreAsciiCase)) return static_cast<ptrdiff_t>(position);
+				mask &= ~(V::LANE_MASK << (lane * V::MASK_BITS));
+			}
+		}
+		return FindScalar(text, textLength, needle, needleLength, ignoreAsciiCase, i);
+	}
+
+	// Runs the single needle search of the instruction set for every needle, findNeedle is called like FindImpl
+	template<typename Char, typename FindNeedle>
+	ptrdiff_t FindAnyWith(const Char* text, size_t textLength, const std::vector<std::basic_string<Char>>& needles, size_t* foundNeedle, const FindNeedle& findNeedle)
+	{
+		size_t shortest = SIZE_MAX;
+		for (const auto& needle : needles) shortest = std::min(shortest, needle.size());
+		if (shortest == 0)
+		{
+			if (foundNeedle) *foundNeedle = std::find_if(needles.begin(), needles.end(), [](const auto& n) { return n.empty(); }) - needles.begin();
+			return 0;
+		}
+
+		ptrdiff_t best = -1;
+		size_t bestNeedle = 0;
+		// Every needle only has to be searched up to the best match found so far
+		for (size_t n = 0; n < needles.size(); n++)
+		{
+			const auto& needle = needles[n];
+			const size_t limit = best < 0 ? textLength : std::min(textLength, static_cast<size_t>(best) + needle.size() - 1);
+			if (limit < needle.size()) continue;
+			const ptrdiff_t position = findNeedle(text, limit, needle.data(), needle.size());
+			if (position >= 0 && (best < 0 || position < best))
+			{
+				best = position;
+				bestNeedle = n;
+			}
+		}
+		if (best >= 0 && foundNeedle) *foundNeedle = bestNeedle;
+		return best;
+	}
+
+#ifdef SEARCH_KERNEL_SSE2
+	template<int CHAR_SIZE>
+	struct Sse2Traits
+	{
+		static constexpr size_t LANES = 16 / CHAR_SIZE;
+		static constexpr unsigned MASK_BITS = CHAR_SIZE;
+		static constexpr uint64_t LANE_MASK = (1u << CHAR_SIZE) - 1;
+
+		static inline __m128i Load(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+		static inline __m128i Broadcast(char c) { return _mm_set1_epi8(c); }
+		static inline __m128i Broadcast(char16_t c) { return _mm_set1_epi16(static_cast<short>(c)); }
+		static inline __m128i Equal(__m128i a, __m128i b) { return CHAR_SIZE == 1 ? _mm_cmpeq_epi8(a, b) : _mm_cmpeq_epi16(a, b); }
+		static inline __m128i Or(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+		static inline __m128i And(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+		static inline uint64_t MoveMask(__m128i a) { return static_cast<uint32_t>(_mm_movemask_epi8(a)); }
+	};
+#endif
+
+#ifdef SEARCH_KERNEL_AVX2
+	__attribute__((target("avx2"))) inline __m256i BroadcastAvx2(char c) { return _mm256_set1_epi8(c); }
+	__attribute__((target("avx2"))) inline __m256i BroadcastAvx2(char16_t c) { return _mm256_set1_epi16(static_cast<short>(c)); }
+
+	template<typename Char>
+	__attribute__((target("avx2"))) inline __m256i EqualAvx2(__m256i a, __m256i b)
+	{
+		if constexpr (sizeof(Char) == 1) return _mm256_cmpeq_epi8(a, b);
+		else return _mm256_cmpeq_epi16(a, b);
+	}
+
+	/**
+	 * Same filter as FindVectorised, written out for AVX2 so everything touching 256 bit registers has the avx2 target.
+	 * A generic kernel instantiated with AVX2 traits would pass the registers between functions compiled
+	 * with and without AVX2, which breaks when the traits aren't inlined, e.g. in debug builds.
+	 */
+	template<typename Char>
+	__attribute__((target("avx2"))) ptrdiff_t FindAvx2(const Char* text, size_t textLength, const Char* needle, size_t needleLength, bool ignoreAsciiCase)
+	{
+		constexpr size_t LANES = 32 / sizeof(Char);
+		constexpr uint64_t LANE_MASK = (1u << sizeof(Char)) - 1;
+		const size_t positions = textLength - needleLength + 1;
+		const Char first = needle[0], last = needle[needleLength - 1];
+		const __m256i firstLower = BroadcastAvx2(first), lastLower = BroadcastAvx2(last);
+		const __m256i firstUpper = BroadcastAvx2(ignoreAsciiCase ? UpperAscii(first) : first);
+		const __m256i lastUpper = BroadcastAvx2(ignoreAsciiCase ? UpperAscii(last) : last);
+
+		size_t i = 0;
+		for (; i + LANES <= positions; i += LANES)
+		{
+			const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+			const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + needleLength - 1));
+			const __m256i eqFirst = _mm256_or_si256(EqualAvx2<Char>(blockFirst, firstLower), EqualAvx2<Char>(blockFirst, firstUpper));
+			const __m256i eqLast = _mm256_or_si256(EqualAvx2<Char>(blockLast, lastLower), EqualAvx2<Char>(blockLast, lastUpper));
+			uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(eqFirst, eqLast)));
+			while (mask)
+			{
+				const unsigned lane = CountTrailingZeros(mask) / sizeof(Char);
+				const size_t position = i + lane;
+				if (Equals(text + position + 1, needle + 1, needleLength - 1, ignoreAsciiCase)) return static_cast<ptrdiff_t>(position);
+				mask &= ~(LANE_MASK << (lane * sizeof(Char)));
+			}
+		}
+		return FindScalar(text, textLength, needle, needleLength, ignoreAsciiCase, i);
+	}
+
+	const bool HAS_AVX2 = __builtin_cpu_supports("avx2");
+#endif
+
+#ifdef SEARCH_KERNEL_NEON
+	template<int CHAR_SIZE>
+	struct NeonTraits;
+
+	template<>
+	struct NeonTraits<1>
+	{
+		static constexpr size_t LANES = 16;
+		static constexpr unsigned MASK_BITS = 4;
+		static constexpr uint64_t LANE_MASK = 0xF;
+
+		static inline uint8x16_t Load(const char* p) { return vld1q_u8(reinterpret_cast<const uint8_t*>(p)); }
+		static inline uint8x16_t Broadcast(char c) { return vdupq_n_u8(static_cast<uint8_t>(c)); }
+		static inline uint8x16_t Equal(uint8x16_t a, uint8x16_t b) { return vceqq_u8(a, b); }
+		static inline uint8x16_t Or(uint8x16_t a, uint8x16_t b) { return vorrq_u8(a, b); }
+		static inline uint8x16_t And(uint8x16_t a, uint8x16_t b) { return vandq_u8(a, b); }
+		// Narrowing shift packs 4 bits per lane into a 64 bit value
+		static inline uint64_t MoveMask(uint8x16_t a) { return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(a), 4)), 0); }
+	};
+
+	template<>
+	struct NeonTraits<2>
+	{
+		static constexpr size_t LANES = 8;
+		static constexpr unsigned MASK_BITS = 8;
+		static constexpr uint64_t LANE_MASK = 0xFF;
+
+		static inline uint16x8_t Load(const char16_t* p) { return vld1q_u16(reinterpret_cast<const uint16_t*>(p)); }
+		static inline uint16x8_t Broadcast(char16_t c) { return vdupq_n_u16(static_cast<uint16_t>(c)); }
+		static inline uint16x8_t Equal(uint16x8_t a, uint16x8_t b) { return vceqq_u16(a, b); }
+		static inline uint16x8_t Or(uint16x8_t a, uint16x8_t b) { return vorrq_u16(a, b); }
+		static inline uint16x8_t And(uint16x8_t a, uint16x8_t b) { return vandq_u16(a, b); }
+		static inline uint64_t MoveMask(uint16x8_t a) { return vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(a)), 0); }
+	};
+#endif
+
+	template<typename Char>
+	ptrdiff_t FindImpl(const Char* text, size_t textLength, const Char* needle, size_t needleLength, bool ignoreAsciiCase)
+	{
+		if (needleLength == 0) return 0;
+		if (textLength < needleLength) return -1;
+#if defined(SEARCH_KERNEL_AVX2)
+		if (HAS_AVX2) return FindAvx2(text, textLength, needle, needleLength, ignoreAsciiCase);
+#endif
+#if defined(SEARCH_KERNEL_SSE2)
+		return FindVectorised<Sse2Traits<sizeof(Char)>>(text, textLength, needle, needleLength, ignoreAsciiCase);
+#elif defined(SEARCH_KERNEL_NEON)
+		return FindVectorised<NeonTraits<sizeof(Char)>>(text, textLength, needle, needleLength, ignoreAsciiCase);
+#else
+		return FindScalar(text, textLength, needle, needleLength, ignoreAsciiCase, 0);
+#endif
+	}
+
+	template<typename Char>
+	ptrdiff_t FindAnyImpl(const Char* text, size_t textLength, const std::vector<std::basic_string<Char>>& needles, bool ignoreAsciiCase, size_t* foundNeedle)
+	{
+		if (needles.empty()) return -1;
+		return FindAnyWith(text, textLength, needles, foundNeedle, [ignoreAsciiCase](const Char* part, size_t partLength, const Char* needle, size_t needleLength) {
+			return FindImpl(part, partLength, needle, needleLength, ignoreAsciiCase);
+		});
+	}
+}
+
+ptrdiff_t SearchKernel::Find(const char16_t* text, size_t textLength, const char16_t* needle, size_t needleLength, bool ignoreAsciiCase)
+{
+	return FindImpl(text, textLength, needle, needleLength, ignoreAsciiCase);
+}
+
+ptrdiff_t SearchKernel::Find(const char* text, size_t textLength, const char* needle, size_t needleLength, bool ignoreAsciiCase)
+{
+	return FindImpl(text, textLength, needle, needleLength, ignoreAsciiCase);
+}
+
+ptrdiff_t SearchKernel::FindAny(const char16_t* text, size_t textLength, const std::vector<std::u16string>& needles, bool ignoreAsciiCase, size_t* foundNeedle)
+{
+	return FindAnyImpl(text, textLength, needles, ignoreAsciiCase, foundNeedle);
+}
+
+ptrdiff_t SearchKernel::FindAny(const char* text, size_t textLength, const std::vector<std::string>& needles, bool ignoreAsciiCase, size_t* foundNeedle)
+{
+	return FindAnyImpl(text, textLength, needles, ignoreAsciiCase, foundNeedle);
+}
+
+const char* SearchKernel::GetInstructionSet()
+{
+#if defined(SEARCH_KERNEL_AVX2)
+	if (HAS_AVX2) return "AVX2";
+#endif
+#if defined(SEARCH_KERNEL_SSE2)
+	return "SSE2";
+#elif defined(SEARCH_KERNEL_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
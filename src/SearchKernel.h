@@ -0,0 +1,51 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Substring search tuned for scanning large amounts of short log lines.
+ * Candidate positions are found by comparing the first and last char of the needle against a whole
+ * SIMD register of text positions at once, only those get verified char by char.
+ * Case insensitive searches only fold ASCII letters and expect an already lower case needle.
+ */
+class SearchKernel final
+{
+public:
+	SearchKernel() = delete;
+
+	// Returns the index of the first occurrence of the needle in the text, or -1
+	static ptrdiff_t Find(const char16_t* text, size_t textLength, const char16_t* needle, size_t needleLength, bool ignoreAsciiCase);
+
+	static ptrdiff_t Find(const char* text, size_t textLength, const char* needle, size_t needleLength, bool ignoreAsciiCase);
+
+	/**
+	 * Returns the index of the earliest occurrence of any of the needles in the text, or -1.
+	 * The index of the needle found at that position is written to foundNeedle if it is not null.
+	 */
+	static ptrdiff_t FindAny(const char16_t* text, size_t textLength, const std::vector<std::u16string>& needles, bool ignoreAsciiCase, size_t* foundNeedle = nullptr);
+
+	static ptrdiff_t FindAny(const char* text, size_t textLength, const std::vector<std::string>& needles, bool ignoreAsciiCase, size_t* foundNeedle = nullptr);
+
+	// Name of the instruction set used by the kernel on this machine, e.g. for profiling output
+	static const char* GetInstructionSet();
+};
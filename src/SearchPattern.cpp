@@ -0,0 +1,288 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SearchPattern.h"
+#include "SearchKernel.h"
+#include <algorithm>
+#include <cctype>
+
+SearchPattern::SearchPattern(const QString& pattern, bool regex, bool matchCase)
+	: pattern(pattern), regex(regex), matchCase(matchCase)
+{
+	if (regex)
+	{
+		QRegularExpression::PatternOptions options = QRegularExpression::DontCaptureOption;
+		if (!matchCase) options |= QRegularExpression::CaseInsensitiveOption;
+		expression = QRegularExpression(pattern, options);
+		// Compile (and JIT) once up front instead of on the first match inside the search loop
+		expression.optimize();
+		requiredLiterals = ExtractRequiredLiterals(pattern);
+		if (requiredLiterals.isEmpty())
+		{
+			for (const QString& literal : ExtractAlternativeLiterals(pattern))
+			{
+				const QString needle = matchCase ? literal : literal.toLower();
+				// The kernel only folds ASCII, without an exact prefilter for every alternative none is possible
+				if (!matchCase && !IsAscii(needle))
+				{
+					alternativeLiterals.clear();
+					break;
+				}
+				alternativeLiterals.emplace_back(reinterpret_cast<const char16_t*>(needle.utf16()), needle.size());
+			}
+		}
+	}
+	else if (!pattern.isEmpty())
+	{
+		requiredLiterals.append(pattern);
+	}
+
+	if (!matchCase)
+	{
+		for (QString& literal : requiredLiterals)
+		{
+			literal = literal.toLower();
+		}
+	}
+
+	for (const QString& literal : requiredLiterals)
+	{
+		if (literal.length() > indexLiteral.length()) indexLiteral = literal;
+	}
+}
+
+bool SearchPattern::Matches(const QString& text) const
+{
+	if (!ContainsRequiredLiterals(text)) return false;
+	return !regex || expression.match(text).hasMatch();
+}
+
+bool SearchPattern::Match(const QString& text, qsizetype from, qsizetype& start, qsizetype& length) const
+{
+	if (regex)
+	{
+		const QRegularExpressionMatch match = expression.match(text, from);
+		if (!match.hasMatch()) return false;
+		start = match.capturedStart();
+		length = match.capturedLength();
+		return true;
+	}
+	if (requiredLiterals.isEmpty()) return false;
+	const QString& literal = requiredLiterals.front();
+	const qsizetype index = IndexOf(QStringView(text).sliced(from), literal, matchCase);
+	if (index < 0) return false;
+	start = from + index;
+	length = literal.length();
+	return true;
+}
+
+bool SearchPattern::ContainsRequiredLiterals(QStringView text) const
+{
+	for (const QString& literal : requiredLiterals)
+	{
+		if (IndexOf(text, literal, matchCase) < 0) return false;
+	}
+	if (!alternativeLiterals.empty())
+	{
+		return SearchKernel::FindAny(reinterpret_cast<const char16_t*>(text.utf16()), text.size(), alternativeLiterals, !matchCase) >= 0;
+	}
+	return true;
+}
+
+qsizetype SearchPattern::IndexOf(QStringView text, QStringView needle, bool matchCase)
+{
+	// Full Unicode case folding is left to Qt, everything else goes through the vectorised kernel
+	if (!matchCase && !IsAscii(needle)) return text.indexOf(needle, 0, Qt::CaseInsensitive);
+	return SearchKernel::Find(reinterpret_cast<const char16_t*>(text.utf16()), text.size(),
+							  reinterpret_cast<const char16_t*>(needle.utf16()), needle.size(), !matchCase);
+}
+
+bool SearchPattern::IsAscii(QStringView text)
+{
+	return std::all_of(text.begin(), text.end(), [](QChar c) { return c.unicode() < 0x80; });
+}
+
+qsizetype SearchPattern::SkipEscapeSequence(const QString& pattern, qsizetype pos)
+{
+	const qsizetype length = pattern.length();
+	const QChar escape = pattern[pos];
+	if (escape.isDigit())
+	{ // Back reference or octal code
+		while (pos + 1 < length && pattern[pos + 1].isDigit()) pos++;
+		return pos;
+	}
+	if (QStringLiteral("xopPNgkc").contains(escape) && pos + 1 < length)
+	{
+		static const QString OPENING = "{<'", CLOSING = "}>'";
+		const qsizetype bracket = OPENING.indexOf(pattern[pos + 1]);
+		if (bracket >= 0)
+		{
+			const qsizetype end = pattern.indexOf(CLOSING[bracket], pos + 2);
+			return end < 0 ? length : end;
+		}
+		if (escape == 'x')
+		{
+			for (int digits = 0; digits < 2 && pos + 1 < length && isxdigit(pattern[pos + 1].toLatin1()); digits++) pos++;
+		}
+		else if (escape == 'g')
+		{
+			while (pos + 1 < length && (pattern[pos + 1].isDigit() || pattern[pos + 1] == '-')) pos++;
+		}
+		else if (escape == 'p' || escape == 'P' || escape == 'c')
+		{
+			pos++;
+		}
+	}
+	return pos;
+}
+
+QStringList SearchPattern::ExtractRequiredLiterals(const QString& pattern)
+{
+	// Inline options might change the meaning of the pattern (e.g. extended mode), so don't guess
+	if (pattern.contains("(?")) return {};
+
+	QStringList literals;
+	QString current;
+	const auto finishLiteral = [&] {
+		if (!current.isEmpty()) literals.append(current);
+		current.clear();
+	};
+
+	const qsizetype length = pattern.length();
+	for (qsizetype pos = 0; pos < length; pos++)
+	{
+		const QChar c = pattern[pos];
+		switch (c.unicode())
+		{
+		case '|': // Top level alternation, no literal is required
+			return {};
+		case '\\':
+			if (pos + 1 < length && !pattern[pos + 1].isLetterOrNumber())
+			{
+				current += pattern[++pos];
+			}
+			else if (pos + 1 < length)
+			{ // Character class shorthand, assertion, code point or back reference
+				finishLiteral();
+				pos = SkipEscapeSequence(pattern, pos + 1);
+			}
+			break;
+		case '[':
+		{ // Skip the whole character class
+			finishLiteral();
+			pos++;
+			if (pos < length && pattern[pos] == '^') pos++;
+			if (pos < length && pattern[pos] == ']') pos++;
+			while (pos < length && pattern[pos] != ']')
+			{
+				if (pattern[pos] == '\\') pos++;
+				pos++;
+			}
+			break;
+		}
+		case '(':
+		{ // Groups might be optional or contain alternations, skip them
+			finishLiteral();
+			int depth = 1;
+			for (pos++; pos < length && depth > 0; pos++)
+			{
+				const QChar g = pattern[pos];
+				if (g == '\\') pos++;
+				else if (g == '(') depth++;
+				else if (g == ')') depth--;
+				else if (g == '[')
+				{
+					for (pos++; pos < length && pattern[pos] != ']'; pos++)
+					{
+						if (pattern[pos] == '\\') pos++;
+					}
+				}
+			}
+			pos--;
+			break;
+		}
+		case '?':
+		case '*':
+		case '{':
+			// The preceding char is optional
+			if (!current.isEmpty()) current.chop(1);
+			finishLiteral();
+			if (c == '{')
+			{
+				while (pos < length && pattern[pos] != '}') pos++;
+			}
+			break;
+		case '+':
+			// The preceding char is required, but might be repeated
+			finishLiteral();
+			break;
+		case '.':
+		case '^':
+		case '$':
+		case ')':
+		case ']':
+		case '}':
+			finishLiteral();
+			break;
+		default:
+			current += c;
+			break;
+		}
+	}
+	finishLiteral();
+	return literals;
+}
+
+QStringList SearchPattern::ExtractAlternativeLiterals(const QString& pattern)
+{
+	if (pattern.contains("(?")) return {};
+
+	QStringList alternatives;
+	qsizetype alternativeStart = 0;
+	int depth = 0;
+	const qsizetype length = pattern.length();
+	for (qsizetype pos = 0; pos <= length; pos++)
+	{
+		if (pos == length || (pattern[pos] == '|' && depth == 0))
+		{
+			alternatives.append(pattern.mid(alternativeStart, pos - alternativeStart));
+			alternativeStart = pos + 1;
+			continue;
+		}
+		const QChar c = pattern[pos];
+		if (c == '\\') pos++;
+		else if (c == '(') depth++;
+		else if (c == ')') depth--;
+		else if (c == '[')
+		{
+			for (pos++; pos < length && pattern[pos] != ']'; pos++)
+			{
+				if (pattern[pos] == '\\') pos++;
+			}
+		}
+	}
+	if (alternatives.size() < 2) return {};
+
+	QStringList literals;
+	for (const QString& alternative : alternatives)
+	{
+		const QStringList required = ExtractRequiredLiterals(alternative);
+		if (required.isEmpty()) return {};
+		literals.append(*std::max_element(required.begin(), required.end(), [](const QString& a, const QString& b) { return a.length() < b.length(); }));
+	}
+	return literals;
+}
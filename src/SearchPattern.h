@@ -0,0 +1,106 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QRegularExpression>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * A compiled search query, either a plain literal or a regular expression.
+ * Regex patterns are JIT compiled once and all literals a match requires are checked
+ * with a cheap substring search first, so most entries never reach the regex engine.
+ */
+class SearchPattern final
+{
+	QString pattern;
+	bool regex = false, matchCase = true;
+	QRegularExpression expression;
+	// Literals every match has to contain, already lower case if the search ignores case
+	QStringList requiredLiterals;
+	// For top level alternations: one literal per alternative, a match has to contain at least one of them
+	std::vector<std::u16string> alternativeLiterals;
+	QString indexLiteral;
+
+public:
+	SearchPattern() = default;
+
+	SearchPattern(const QString& pattern, bool regex, bool matchCase);
+
+	[[nodiscard]] bool IsValid() const { return !regex || expression.isValid(); }
+
+	[[nodiscard]] QString GetErrorString() const { return regex ? expression.errorString() : QString(); }
+
+	[[nodiscard]] bool IsEmpty() const { return pattern.isEmpty(); }
+
+	[[nodiscard]] const QString& GetPattern() const { return pattern; }
+
+	[[nodiscard]] bool IsRegex() const { return regex; }
+
+	[[nodiscard]] bool IsMatchCase() const { return matchCase; }
+
+	// The longest literal all matches contain, suitable for narrowing down candidates with the trigram index
+	[[nodiscard]] const QString& GetIndexLiteral() const { return indexLiteral; }
+
+	// Literals every match contains, lower case if the pattern ignores case
+	[[nodiscard]] const QStringList& GetRequiredLiterals() const { return requiredLiterals; }
+
+	[[nodiscard]] bool Matches(const QString& text) const;
+
+	// Finds the first match starting at or after the given position
+	bool Match(const QString& text, qsizetype from, qsizetype& start, qsizetype& length) const;
+
+	// Finds the first match in the text, checking the required literals before running the regex
+	bool FindFirst(const QString& text, qsizetype& start, qsizetype& length) const
+	{
+		return !IsEmpty() && ContainsRequiredLiterals(text) && Match(text, 0, start, length);
+	}
+
+	// Calls the callback with the start and length of every non overlapping match in the text
+	template<typename Callback>
+	void ForEachMatch(const QString& text, Callback&& callback) const
+	{
+		if (IsEmpty() || !ContainsRequiredLiterals(text)) return;
+		qsizetype from = 0, start, length;
+		while (from <= text.length() && Match(text, from, start, length))
+		{
+			callback(start, length);
+			from = start + std::max<qsizetype>(length, 1);
+		}
+	}
+
+	// Collects the literal sequences a regex match can not do without, returns nothing if no safe statement can be made
+	[[nodiscard]] static QStringList ExtractRequiredLiterals(const QString& pattern);
+
+	// Collects one required literal per top level alternative, returns nothing if any alternative has none
+	[[nodiscard]] static QStringList ExtractAlternativeLiterals(const QString& pattern);
+
+	[[nodiscard]] static qsizetype IndexOf(QStringView text, QStringView needle, bool matchCase);
+
+	// Cheap necessary condition for a match, also holds for any text containing the one that gets matched
+	[[nodiscard]] bool ContainsRequiredLiterals(QStringView text) const;
+
+private:
+	// Returns the position of the last char of the escape sequence starting with the char at pos
+	[[nodiscard]] static qsizetype SkipEscapeSequence(const QString& pattern, qsizetype pos);
+
+	[[nodiscard]] static bool IsAscii(QStringView text);
+};
@@ -0,0 +1,145 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SearchResultModel.h"
+#include <QApplication>
+#include <QPainter>
+#include <QTextLayout>
+
+namespace
+{
+	const QColor MATCH_HIGHLIGHT_COLOR = QColor(255, 230, 0, 160);
+}
+
+SearchResultModel::SearchResultModel(const LogHolder* holder, QObject* parent)
+	: QAbstractListModel(parent), logHolder(holder)
+{}
+
+void SearchResultModel::Clear()
+{
+	beginResetModel();
+	hits.clear();
+	rowFirstHit.clear();
+	endResetModel();
+}
+
+void SearchResultModel::AppendHits(const std::vector<SearchHit>& batch)
+{
+	if (batch.empty()) return;
+	std::vector<uint32_t> newRows;
+	uint32_t lastEntry = rowFirstHit.empty() ? UINT32_MAX : hits[rowFirstHit.back()].entryIndex;
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		if (batch[i].entryIndex != lastEntry)
+		{
+			newRows.push_back(static_cast<uint32_t>(hits.size() + i));
+			lastEntry = batch[i].entryIndex;
+		}
+	}
+
+	if (newRows.empty())
+	{
+		hits.insert(hits.end(), batch.begin(), batch.end());
+		return;
+	}
+	const int firstRow = static_cast<int>(rowFirstHit.size());
+	beginInsertRows(QModelIndex(), firstRow, firstRow + static_cast<int>(newRows.size()) - 1);
+	hits.insert(hits.end(), batch.begin(), batch.end());
+	rowFirstHit.insert(rowFirstHit.end(), newRows.begin(), newRows.end());
+	endInsertRows();
+}
+
+int SearchResultModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : static_cast<int>(rowFirstHit.size());
+}
+
+const SearchHit* SearchResultModel::GetHit(int row) const
+{
+	if (row < 0 || row >= rowFirstHit.size()) return nullptr;
+	return &hits[rowFirstHit[row]];
+}
+
+std::pair<const SearchHit*, const SearchHit*> SearchResultModel::GetHits(int row) const
+{
+	if (row < 0 || row >= rowFirstHit.size()) return { nullptr, nullptr };
+	const size_t end = row + 1 < rowFirstHit.size() ? rowFirstHit[row + 1] : hits.size();
+	return { hits.data() + rowFirstHit[row], hits.data() + end };
+}
+
+const LogEntry* SearchResultModel::GetEntry(int row) const
+{
+	const SearchHit* hit = GetHit(row);
+	return hit ? &logHolder->GetEntries()[hit->entryIndex] : nullptr;
+}
+
+QVariant SearchResultModel::data(const QModelIndex& index, int role) const
+{
+	const LogEntry* entry = GetEntry(index.row());
+	if (!entry) return {};
+	switch (role)
+	{
+	case Qt::DisplayRole:
+		return logHolder->GetMessage(entry);
+	case Qt::ToolTipRole:
+		return tr("Line %1").arg(entry->lineNumber);
+	default:
+		return {};
+	}
+}
+
+void SearchResultDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+	QStyleOptionViewItem opt = option;
+	initStyleOption(&opt, index);
+	const QString text = opt.text;
+	opt.text.clear();
+
+	// Let the style paint the background and selection, the text is drawn below with the matches highlighted
+	const QWidget* widget = opt.widget;
+	QStyle* style = widget ? widget->style() : QApplication::style();
+	style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+	const QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget);
+
+	QList<QTextLayout::FormatRange> formats;
+	const auto [firstHit, endHit] = model->GetHits(index.row());
+	for (const SearchHit* hit = firstHit; hit != endHit; hit++)
+	{
+		QTextLayout::FormatRange range;
+		range.start = hit->start;
+		range.length = hit->length;
+		range.format.setBackground(MATCH_HIGHLIGHT_COLOR);
+		formats.append(range);
+	}
+
+	QTextLayout layout(text, opt.font);
+	layout.setFormats(formats);
+	layout.beginLayout();
+	QTextLine line = layout.createLine();
+	if (line.isValid())
+	{
+		line.setNumColumns(text.length());
+	}
+	layout.endLayout();
+
+	painter->save();
+	painter->setClipRect(textRect);
+	painter->setPen(opt.palette.color(opt.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text));
+	const qreal top = textRect.top() + (textRect.height() - line.height()) / 2;
+	layout.draw(painter, QPointF(textRect.left(), top));
+	painter->restore();
+}
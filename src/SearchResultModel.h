@@ -0,0 +1,75 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include <vector>
+#include "LogHolder.h"
+#include "SearchSession.h"
+
+/**
+ * Virtual list of the entries matched by a search. Only the hits are stored,
+ * the text of a row is fetched from the log holder when the row gets painted.
+ */
+class SearchResultModel final : public QAbstractListModel
+{
+	Q_OBJECT
+
+	const LogHolder* logHolder;
+	// Hits of all result rows in log order and the index of the first hit of every row
+	std::vector<SearchHit> hits;
+	std::vector<uint32_t> rowFirstHit;
+
+public:
+	explicit SearchResultModel(const LogHolder* holder, QObject* parent = nullptr);
+
+	~SearchResultModel() override = default;
+
+	void Clear();
+
+	// The hits of an entry must not be split across calls
+	void AppendHits(const std::vector<SearchHit>& batch);
+
+	[[nodiscard]] int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+	[[nodiscard]] QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+	[[nodiscard]] const LogEntry* GetEntry(int row) const;
+
+	// Returns the first hit of the row
+	[[nodiscard]] const SearchHit* GetHit(int row) const;
+
+	// Returns the range of hits belonging to the row
+	[[nodiscard]] std::pair<const SearchHit*, const SearchHit*> GetHits(int row) const;
+};
+
+// Paints search results with their matches highlighted
+class SearchResultDelegate final : public QStyledItemDelegate
+{
+	Q_OBJECT
+
+	const SearchResultModel* model;
+
+public:
+	explicit SearchResultDelegate(const SearchResultModel* model, QObject* parent = nullptr)
+		: QStyledItemDelegate(parent), model(model)
+	{}
+
+	void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+};
@@ -0,0 +1,94 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <atomic>
+#include <vector>
+
+#include "LogHolder.h"
+#include "SearchPattern.h"
+
+/**
+ * The entry scan shared by the search of a tab and the global search.
+ * Visits the entries that may contain a match in log order, using the candidates of the search index if it has any
+ * and otherwise skipping the chunks of the zone map whose messages can't contain the literals of the pattern.
+ */
+class SearchScan final
+{
+	static constexpr uint32_t CANCEL_CHECK_INTERVAL = 1024;
+	// The first results are shown right away, later ones are collected into bigger batches
+	static constexpr size_t FIRST_BATCH_SIZE = 100;
+	static constexpr int BATCH_INTERVAL_MS = 100;
+
+	const LogHolder* logHolder;
+	const SearchPattern& pattern;
+	const std::atomic_bool& cancelled;
+	QElapsedTimer batchTimer;
+	bool firstBatchSent = false;
+
+public:
+	SearchScan(const LogHolder* logHolder, const SearchPattern& pattern, const std::atomic_bool& cancelled)
+		: logHolder(logHolder), pattern(pattern), cancelled(cancelled)
+	{
+		batchTimer.start();
+	}
+
+	// Calls visit with the index of every entry that may match, returns false if the scan got cancelled
+	template<typename Visitor>
+	bool ForEachCandidate(Visitor&& visit) const
+	{
+		const size_t entryCount = logHolder->GetEntries().size();
+		uint32_t checked = 0;
+		std::vector<uint32_t> candidates;
+		const TrigramIndex* index = logHolder->GetSearchIndex();
+		if (index && index->FindCandidates(pattern.GetIndexLiteral(), entryCount, candidates))
+		{
+			for (const uint32_t candidate : candidates)
+			{
+				if (++checked % CANCEL_CHECK_INTERVAL == 0 && cancelled) return false;
+				visit(candidate);
+			}
+			return !cancelled;
+		}
+
+		const ZoneMap& zoneMap = logHolder->GetZoneMap();
+		const std::vector<uint64_t> trigrams = ZoneMap::GetTrigrams(pattern.GetRequiredLiterals());
+		for (uint32_t i = 0; i < entryCount; i++)
+		{
+			if (i % ZoneMap::CHUNK_SIZE == 0 && !trigrams.empty() && i / ZoneMap::CHUNK_SIZE < zoneMap.GetChunkCount()
+				&& !zoneMap.MayContainTrigrams(i / ZoneMap::CHUNK_SIZE, trigrams))
+			{
+				i += ZoneMap::CHUNK_SIZE - 1;
+				continue;
+			}
+			if (++checked % CANCEL_CHECK_INTERVAL == 0 && cancelled) return false;
+			visit(i);
+		}
+		return !cancelled;
+	}
+
+	// Whether a batch with results of that many entries should be posted now, a new batch interval starts if so
+	bool ShouldPostBatch(size_t batchEntries)
+	{
+		if ((firstBatchSent || batchEntries < FIRST_BATCH_SIZE) && batchTimer.elapsed() < BATCH_INTERVAL_MS) return false;
+		firstBatchSent = true;
+		batchTimer.restart();
+		return true;
+	}
+};
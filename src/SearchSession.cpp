@@ -0,0 +1,91 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SearchSession.h"
+#include "Profiler.hpp"
+#include <algorithm>
+
+void SearchSession::UpdateFilter()
+{
+	const auto currentFilteredEntries = logHolder->GetFilteredEntriesSnapshot();
+	if (currentFilteredEntries == filteredEntries) return;
+	BlockProfiler profiler("Update search session");
+	filteredEntries = currentFilteredEntries;
+	visibleHits.clear();
+	visibleRows.clear();
+
+	// Hits and filtered entries are both in log order, so a single merge pass is enough
+	const LogEntry* firstEntry = logHolder->GetEntries().data();
+	const auto begin = filteredEntries->begin(), end = filteredEntries->end();
+	auto filteredIt = begin;
+	for (uint32_t i = 0; i < hits.size() && filteredIt != end; i++)
+	{
+		const LogEntry* entry = firstEntry + hits[i].entryIndex;
+		filteredIt = std::lower_bound(filteredIt, end, entry);
+		if (filteredIt != end && *filteredIt == entry)
+		{
+			visibleHits.push_back(i);
+			visibleRows.push_back(static_cast<uint32_t>(filteredIt - begin));
+		}
+	}
+}
+
+std::vector<SearchHit> SearchSession::GetVisibleHits() const
+{
+	std::vector<SearchHit> visible;
+	visible.reserve(visibleHits.size());
+	for (const uint32_t hit : visibleHits)
+	{
+		visible.push_back(hits[hit]);
+	}
+	return visible;
+}
+
+size_t SearchSession::LowerBound(size_t row, int column) const
+{
+	size_t low = 0, high = visibleHits.size();
+	while (low < high)
+	{
+		const size_t mid = low + (high - low) / 2;
+		const size_t midRow = visibleRows[mid];
+		if (midRow < row || (midRow == row && hits[visibleHits[mid]].start < column))
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	return low;
+}
+
+std::optional<SearchSession::Position> SearchSession::FindNext(size_t row, int column)
+{
+	UpdateFilter();
+	if (visibleHits.empty()) return std::nullopt;
+	const size_t next = LowerBound(row, column + 1);
+	return GetVisiblePosition(next < visibleHits.size() ? next : 0);
+}
+
+std::optional<SearchSession::Position> SearchSession::FindPrevious(size_t row, int column)
+{
+	UpdateFilter();
+	if (visibleHits.empty()) return std::nullopt;
+	const size_t previous = LowerBound(row, column);
+	return GetVisiblePosition(previous > 0 ? previous - 1 : visibleHits.size() - 1);
+}
@@ -0,0 +1,89 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "LogHolder.h"
+#include <memory>
+#include <optional>
+#include <vector>
+
+struct SearchHit
+{
+	uint32_t entryIndex;
+	int start, length;
+};
+
+/**
+ * Holds the hits of a search over all entries of a log holder, sorted by their position in the log.
+ * Navigating between hits is a binary search, changing the filter only requires a merge of the hits
+ * with the new filtered entries and never rescans the log text.
+ */
+class SearchSession final
+{
+public:
+	struct Position
+	{
+		size_t row;
+		int start, length;
+	};
+
+private:
+	const LogHolder* logHolder;
+	std::vector<SearchHit> hits;
+	// The filtered entries the visible hits have been calculated for
+	std::shared_ptr<const std::vector<const LogEntry*>> filteredEntries;
+	// Indexes of the hits belonging to filtered entries and the row of these entries in the filtered view
+	std::vector<uint32_t> visibleHits;
+	std::vector<uint32_t> visibleRows;
+
+public:
+	explicit SearchSession(const LogHolder* holder) : logHolder(holder)
+	{}
+
+	// Hits have to be added in log order
+	void AddHit(uint32_t entryIndex, int start, int length)
+	{
+		hits.push_back({ entryIndex, start, length });
+	}
+
+	// Recalculates the visible hits if the filtered entries of the log holder have changed since the last call
+	void UpdateFilter();
+
+	[[nodiscard]] const std::vector<SearchHit>& GetHits() const { return hits; }
+
+	[[nodiscard]] size_t GetVisibleHitCount() const { return visibleHits.size(); }
+
+	// Hits of the filtered entries in log order, as of the last UpdateFilter
+	[[nodiscard]] std::vector<SearchHit> GetVisibleHits() const;
+
+	// Finds the first visible hit after the given position in the filtered view, wrapping around at the end
+	[[nodiscard]] std::optional<Position> FindNext(size_t row, int column);
+
+	// Finds the last visible hit before the given position in the filtered view, wrapping around at the start
+	[[nodiscard]] std::optional<Position> FindPrevious(size_t row, int column);
+
+private:
+	[[nodiscard]] Position GetVisiblePosition(size_t visibleIndex) const
+	{
+		const SearchHit& hit = hits[visibleHits[visibleIndex]];
+		return { visibleRows[visibleIndex], hit.start, hit.length };
+	}
+
+	// Index of the first visible hit that is not before the given position
+	[[nodiscard]] size_t LowerBound(size_t row, int column) const;
+};
@@ -18,6 +18,7 @@
 #include "SettingsWindow.h"
 #include "LogProfile.h"
 #include "LogLevel.h"
+#include "LogFilter.h"
 
 #include <QDebug>
 #include <QMessageBox>
@@ -39,6 +40,7 @@ SettingsWindow::SettingsWindow(QWidget* parent)
 void SettingsWindow::LoadTabGeneral()
 {
 	ui.cbCOW->setCheckState(config->UseCopyOnWriteEnabled() ? Qt::CheckState::Checked : Qt::CheckState::Unchecked);
+	ui.cbCompressMessages->setCheckState(config->UseMessageCompression() ? Qt::CheckState::Checked : Qt::CheckState::Unchecked);
 }
 
 void SettingsWindow::LoadTabProfiles()
@@ -119,6 +121,7 @@ void SettingsWindow::SetAllTextBoxes(const std::shared_ptr<LogProfile>& profile)
 	ui.profileSystemInfoDeviceBox->setPlainText(profile->GetSystemInfoDeviceRegex());
 	ui.profileSystemInfoOsBox->setPlainText(profile->GetSystemInfoOsRegex());
 	ui.systemInfoLinesBox->setPlainText(QString::number(profile->GetSystemInfoLinesToCheck()));
+	ui.profileIngestFilterBox->setPlainText(profile->GetIngestFilter());
 
 	// Log Levels
 	ui.logLevelTable->setRowCount(profile->GetLogLevels().size());
@@ -162,6 +165,7 @@ void SettingsWindow::ClearAllFields()
 	ui.profileSystemInfoDeviceBox->clear();
 	ui.profileSystemInfoOsBox->clear();
 	ui.systemInfoLinesBox->clear();
+	ui.profileIngestFilterBox->clear();
 
 	// Log Levels
 	ui.logLevelTable->clearContents();
@@ -182,6 +186,14 @@ void SettingsWindow::SaveToProfile(std::shared_ptr<LogProfile>& profile)
 	profile->SetSystemInfoDeviceRegex(ui.profileSystemInfoDeviceBox->toPlainText());
 	profile->SetSystemInfoOsRegex(ui.profileSystemInfoOsBox->toPlainText());
 	profile->SetLinesToCheckForSystemInformation(ui.systemInfoLinesBox->toPlainText().toUInt());
+	const QString ingestFilter = ui.profileIngestFilterBox->toPlainText().trimmed();
+	if (!ingestFilter.isEmpty())
+	{ // The parser ignores filters it can't use, so the profile would load everything
+		const LogFilter filter(ingestFilter);
+		const QString error = filter.IsValid() ? filter.GetIngestError() : filter.GetError();
+		if (!error.isEmpty()) QMessageBox::warning(this, tr("Invalid ingest filter"), error);
+	}
+	profile->SetIngestFilter(ingestFilter);
 
 	// Log Levels
 	std::vector<std::shared_ptr<LogLevel>> levels;
@@ -326,3 +338,8 @@ void SettingsWindow::on_cbCOW_stateChanged(int state)
 {
 	config->SetCopyOnWrite(state == Qt::CheckState::Checked);
 }
+
+void SettingsWindow::on_cbCompressMessages_stateChanged(int state)
+{
+	config->SetMessageCompression(state == Qt::CheckState::Checked);
+}
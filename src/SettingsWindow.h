@@ -32,6 +32,8 @@ public:
 private slots:
 	void on_cbCOW_stateChanged(int state);
 
+	void on_cbCompressMessages_stateChanged(int state);
+
 	void on_addProfileButton_clicked();
 	void on_removeProfileButton_clicked();
 	void on_importProfileButton_clicked();
@@ -0,0 +1,172 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TemplateMiner.h"
+#include "LogEntry.h"
+#include <algorithm>
+
+namespace
+{
+	const QString WILDCARD = QStringLiteral("<*>");
+}
+
+void TemplateMiner::Tokenize(QStringView message, std::vector<QStringView>& tokens)
+{
+	tokens.clear();
+	qsizetype start = -1;
+	for (qsizetype i = 0; i <= message.size(); i++)
+	{
+		const bool separator = i == message.size() || message[i].isSpace() || message[i] == QChar(LogEntry::LINE_BREAK);
+		if (separator && start >= 0)
+		{
+			tokens.push_back(message.mid(start, i - start));
+			start = -1;
+		}
+		else if (!separator && start < 0)
+		{
+			start = i;
+		}
+	}
+}
+
+bool TemplateMiner::HasDigit(QStringView token)
+{
+	return std::any_of(token.begin(), token.end(), [](QChar c) { return c.isDigit(); });
+}
+
+uint32_t TemplateMiner::FindLeaf(const std::vector<QStringView>& tokens)
+{
+	auto [lengthNode, inserted] = lengthNodes.try_emplace(tokens.size(), static_cast<uint32_t>(nodes.size()));
+	if (inserted) nodes.emplace_back();
+	uint32_t node = lengthNode->second;
+
+	for (size_t depth = 0; depth < PREFIX_DEPTH && depth < tokens.size(); depth++)
+	{
+		// Tokens with digits are most likely parameters, they shouldn't split the tree
+		QString key = HasDigit(tokens[depth]) ? WILDCARD : tokens[depth].toString();
+		auto child = nodes[node].children.constFind(key);
+		if (child == nodes[node].children.constEnd() && nodes[node].children.size() >= MAX_CHILDREN)
+		{ // Full nodes send everything else to their wildcard child
+			key = WILDCARD;
+			child = nodes[node].children.constFind(key);
+		}
+		if (child == nodes[node].children.constEnd())
+		{
+			const uint32_t created = static_cast<uint32_t>(nodes.size());
+			nodes.emplace_back();
+			nodes[node].children.insert(key, created);
+			node = created;
+		}
+		else
+		{
+			node = child.value();
+		}
+	}
+	return node;
+}
+
+uint32_t TemplateMiner::Add(QStringView message)
+{
+	std::vector<QStringView>& tokens = tokenBuffer;
+	Tokenize(message, tokens);
+	const uint32_t leaf = FindLeaf(tokens);
+
+	// Most similar template of the leaf, ties go to the more general one
+	uint32_t best = NO_TEMPLATE;
+	double bestSimilarity = -1;
+	size_t bestParameters = 0;
+	for (const uint32_t id : nodes[leaf].templateIds)
+	{
+		const std::vector<QString>& templateTokens = templates[id].tokens;
+		size_t equal = 0, parameters = 0;
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			if (templateTokens[i] == WILDCARD) parameters++;
+			else if (templateTokens[i] == tokens[i]) equal++;
+		}
+		const double similarity = tokens.empty() ? 1.0 : static_cast<double>(equal) / static_cast<double>(tokens.size());
+		if (similarity > bestSimilarity || (similarity == bestSimilarity && parameters > bestParameters))
+		{
+			best = id;
+			bestSimilarity = similarity;
+			bestParameters = parameters;
+		}
+	}
+
+	if (best != NO_TEMPLATE && bestSimilarity >= SIMILARITY_THRESHOLD)
+	{
+		Template& match = templates[best];
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			if (match.tokens[i] != tokens[i] && match.tokens[i] != WILDCARD) match.tokens[i] = WILDCARD;
+		}
+		match.count++;
+		return best;
+	}
+
+	Template& created = templates.emplace_back();
+	created.tokens.reserve(tokens.size());
+	for (const QStringView token : tokens)
+	{
+		created.tokens.push_back(HasDigit(token) ? WILDCARD : token.toString());
+	}
+	created.count = 1;
+	const uint32_t id = static_cast<uint32_t>(templates.size() - 1);
+	nodes[leaf].templateIds.push_back(id);
+	return id;
+}
+
+QString TemplateMiner::GetTemplateText(uint32_t id) const
+{
+	QString text;
+	for (const QString& token : templates[id].tokens)
+	{
+		if (!text.isEmpty()) text += ' ';
+		text += token;
+	}
+	return text;
+}
+
+QStringList TemplateMiner::ExtractParameters(uint32_t id, QStringView message) const
+{
+	std::vector<QStringView> tokens;
+	Tokenize(message, tokens);
+	const std::vector<QString>& templateTokens = templates[id].tokens;
+	QStringList parameters;
+	for (size_t i = 0; i < tokens.size() && i < templateTokens.size(); i++)
+	{
+		if (templateTokens[i] == WILDCARD) parameters.append(tokens[i].toString());
+	}
+	return parameters;
+}
+
+size_t TemplateMiner::GetMemoryUsage() const
+{
+	size_t usage = nodes.capacity() * sizeof(Node) + templates.capacity() * sizeof(Template);
+	for (const Node& node : nodes)
+	{
+		usage += node.children.size() * (sizeof(QString) + sizeof(uint32_t)) + node.templateIds.capacity() * sizeof(uint32_t);
+	}
+	for (const Template& entry : templates)
+	{
+		for (const QString& token : entry.tokens)
+		{
+			usage += sizeof(QString) + token.size() * sizeof(QChar);
+		}
+	}
+	return usage;
+}
@@ -0,0 +1,85 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Online clustering of messages into templates, following the Drain algorithm.
+ * Messages are split into tokens and routed through a fixed depth tree by their token count and first tokens,
+ * the leaf holds the templates the message gets compared with. A message joins the most similar template
+ * if enough of its tokens are equal, the positions that differ become parameters (<*>) of the template.
+ * Ids are assigned in the order templates are discovered and never change, only the template text gets more general.
+ */
+class TemplateMiner final
+{
+public:
+	static constexpr uint32_t NO_TEMPLATE = UINT32_MAX;
+
+	struct Template
+	{
+		std::vector<QString> tokens;
+		uint64_t count = 0;
+	};
+
+	// Assigns the message to a template, creating a new one if none is similar enough, and returns its id
+	uint32_t Add(QStringView message);
+
+	[[nodiscard]] size_t GetTemplateCount() const { return templates.size(); }
+
+	[[nodiscard]] const Template& GetTemplate(uint32_t id) const { return templates[id]; }
+
+	// Tokens joined by spaces, parameters are shown as <*>
+	[[nodiscard]] QString GetTemplateText(uint32_t id) const;
+
+	// The tokens of a message of the template at the positions of the template's parameters
+	[[nodiscard]] QStringList ExtractParameters(uint32_t id, QStringView message) const;
+
+	// Memory used by the tree and the templates, in bytes
+	[[nodiscard]] size_t GetMemoryUsage() const;
+
+private:
+	// Depth of the prefix tree below the token count, as well as the Drain defaults for similarity and fan out
+	static constexpr size_t PREFIX_DEPTH = 2;
+	static constexpr double SIMILARITY_THRESHOLD = 0.5;
+	static constexpr size_t MAX_CHILDREN = 100;
+
+	struct Node
+	{
+		QHash<QString, uint32_t> children;
+		std::vector<uint32_t> templateIds;
+	};
+
+	// Splits on white space and on the line breaks of multi-line entries
+	static void Tokenize(QStringView message, std::vector<QStringView>& tokens);
+
+	static bool HasDigit(QStringView token);
+
+	[[nodiscard]] uint32_t FindLeaf(const std::vector<QStringView>& tokens);
+
+	std::vector<Node> nodes;
+	std::unordered_map<size_t, uint32_t> lengthNodes;
+	std::vector<Template> templates;
+	std::vector<QStringView> tokenBuffer;
+};
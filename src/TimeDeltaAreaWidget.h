@@ -0,0 +1,129 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "EditInfoAreaWidget.h"
+#include "LogHolder.h"
+#include <algorithm>
+
+class TimeDeltaAreaWidget : public EditInfoAreaWidget
+{
+public:
+	enum Mode {
+		SINCE_START, SINCE_PREVIOUS
+	};
+
+private:
+	const Mode mode;
+	const LogHolder* logHolder = nullptr;
+	QString durationString;
+	QColor fontColor = Qt::black;
+	QColor fontBackgroundColor = Qt::transparent;
+	EditInfoAreaWidgetMetaDescription description;
+
+	// Gaps to the previous entry that are at least this long get highlighted
+	static constexpr std::chrono::milliseconds SLOW_OPERATION_THRESHOLD{ 1000 };
+	// Wide enough for "+9.999s" while the log holder has no entries
+	static constexpr int MIN_DURATION_CHARS = 7;
+
+public:
+	TimeDeltaAreaWidget(InfoAreaEnabledPlainTextEdit* editor, Mode mode, int marginLeft = 3, int marginRight = 3)
+		: EditInfoAreaWidget(editor, [this](auto && lnr) { return GetMetaDescriptionForLine(std::forward<decltype(lnr)>(lnr)); }, marginLeft, marginRight)
+		, mode(mode), description({ durationString, fontColor, fontBackgroundColor, Qt::AlignRight })
+	{
+		SetBackgroundColor(Qt::lightGray);
+	}
+
+	char GetWidthCalculationChar() override
+	{
+		return '9';
+	}
+
+	void SetLogHolder(const LogHolder* holder)
+	{
+		logHolder = holder;
+		SetWidthForCharCount(GetMaxDurationChars());
+	}
+
+	// The formatted length grows with the magnitude, so only the largest and smallest duration need to fit
+	int GetMaxDurationChars() const
+	{
+		int chars = MIN_DURATION_CHARS;
+		if (!logHolder) return chars;
+		const std::vector<int64_t>& durations = mode == SINCE_START ? logHolder->GetTimeSinceStartColumn() : logHolder->GetTimeSincePreviousColumn();
+		if (durations.empty()) return chars;
+		const auto [min, max] = std::minmax_element(durations.begin(), durations.end());
+		for (const int64_t duration : { *min, *max })
+		{
+			QString formatted;
+			FormatDuration(std::chrono::milliseconds(duration), formatted);
+			chars = std::max(chars, static_cast<int>(formatted.size()));
+		}
+		return chars;
+	}
+
+	EditInfoAreaWidgetMetaDescription GetMetaDescriptionForLine(int lineNr)
+	{
+		durationString.clear();
+		fontColor = Qt::black;
+		if (!logHolder || logHolder->GetFilteredEntries().size() <= lineNr) return description;
+
+		const LogEntry* entry = logHolder->GetFilteredEntries()[lineNr];
+		const std::chrono::milliseconds duration = mode == SINCE_START ? logHolder->GetTimeSinceStart(entry) : logHolder->GetTimeSincePrevious(entry);
+		FormatDuration(duration, durationString);
+		if (mode == SINCE_PREVIOUS && duration >= SLOW_OPERATION_THRESHOLD)
+		{
+			fontColor = Qt::red;
+		}
+		return description;
+	}
+
+	// Formats the duration only when a line gets painted, so no strings need to be kept per entry
+	static void FormatDuration(std::chrono::milliseconds duration, QString& target)
+	{
+		int64_t ms = duration.count();
+		if (ms < 0)
+		{
+			target += '-';
+			ms = -ms;
+		}
+		else
+		{
+			target += '+';
+		}
+		if (ms < 1000)
+		{
+			target += QString::number(ms) + "ms";
+			return;
+		}
+		const int64_t seconds = ms / 1000, millis = ms % 1000;
+		if (seconds < 60)
+		{
+			target += QString::number(seconds) + '.' + QString::number(millis).rightJustified(3, '0') + 's';
+			return;
+		}
+		const int64_t minutes = seconds / 60, hours = minutes / 60;
+		if (hours > 0)
+		{
+			target += QString::number(hours) + ':';
+		}
+		target += QString::number(minutes % 60).rightJustified(hours > 0 ? 2 : 1, '0') + ':'
+				+ QString::number(seconds % 60).rightJustified(2, '0') + '.'
+				+ QString::number(millis).rightJustified(3, '0');
+	}
+};
@@ -0,0 +1,104 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TrigramIndex.h"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <mutex>
+
+void TrigramIndex::Update(const MessageStore& messages)
+{
+	BlockProfiler profiler("Build trigram index");
+	std::unordered_map<uint64_t, std::vector<uint32_t>> batch;
+	MessageStore::Reader reader(messages);
+	const size_t count = messages.GetCount();
+	size_t start = indexedEntries;
+	while (start < count && !cancelled)
+	{
+		const size_t end = std::min(count, start + BATCH_SIZE);
+		for (size_t i = start; i < end; i++)
+		{
+			const QString message = reader.GetMessage(i);
+			const QChar* text = message.constData();
+			for (qsizetype pos = 0; pos + TRIGRAM_LENGTH <= message.length(); pos++)
+			{
+				auto& list = batch[MakeTrigram(text + pos)];
+				if (list.empty() || list.back() != i)
+				{
+					list.push_back(static_cast<uint32_t>(i));
+				}
+			}
+		}
+
+		{ // Batches are indexed in order, so appending keeps every posting list sorted
+			std::unique_lock lock(postingsMutex);
+			for (auto& [trigram, list] : batch)
+			{
+				auto& target = postings[trigram];
+				target.insert(target.end(), list.begin(), list.end());
+			}
+			indexedEntries = end;
+		}
+		batch.clear();
+		start = end;
+	}
+}
+
+bool TrigramIndex::FindCandidates(QStringView literal, size_t entryCount, std::vector<uint32_t>& candidates) const
+{
+	candidates.clear();
+	if (literal.length() < TRIGRAM_LENGTH) return false;
+
+	size_t indexed;
+	{
+		std::shared_lock lock(postingsMutex);
+		// Read together with the postings, a batch published afterwards is neither in them nor in the tail below
+		indexed = indexedEntries;
+		std::vector<const std::vector<uint32_t>*> lists;
+		for (qsizetype pos = 0; pos + TRIGRAM_LENGTH <= literal.length(); pos++)
+		{
+			const auto it = postings.find(MakeTrigram(literal.data() + pos));
+			if (it == postings.end())
+			{ // No indexed entry contains this trigram
+				lists.clear();
+				break;
+			}
+			lists.push_back(&it->second);
+		}
+
+		if (!lists.empty())
+		{
+			// Start with the rarest trigram to keep the intermediate results small
+			std::sort(lists.begin(), lists.end(), [](const auto* left, const auto* right) { return left->size() < right->size(); });
+			candidates = *lists.front();
+			std::vector<uint32_t> intersection;
+			for (size_t i = 1; i < lists.size() && !candidates.empty(); i++)
+			{
+				intersection.clear();
+				std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(intersection));
+				candidates.swap(intersection);
+			}
+		}
+	}
+
+	// Entries that are not indexed yet are always candidates
+	for (size_t i = indexed; i < entryCount; i++)
+	{
+		candidates.push_back(static_cast<uint32_t>(i));
+	}
+	return true;
+}
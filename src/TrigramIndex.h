@@ -0,0 +1,71 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "MessageStore.h"
+#include <QStringView>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Inverted index from case folded trigrams of the log messages to the indexes of the entries containing them.
+ * The index is filled in batches and can be queried while it is still being built,
+ * entries that have not been indexed yet are simply reported as candidates.
+ */
+class TrigramIndex final
+{
+	std::unordered_map<uint64_t, std::vector<uint32_t>> postings;
+	mutable std::shared_mutex postingsMutex;
+	std::atomic<size_t> indexedEntries = 0;
+	std::atomic_bool cancelled = false;
+
+	static constexpr size_t BATCH_SIZE = 65536;
+
+public:
+	static constexpr int TRIGRAM_LENGTH = 3;
+
+	TrigramIndex() = default;
+
+	~TrigramIndex() = default;
+
+	// Indexes all entries that have not been indexed yet, entries must only ever be appended
+	void Update(const MessageStore& messages);
+
+	void Cancel() { cancelled = true; }
+
+	[[nodiscard]] size_t GetIndexedEntryCount() const { return indexedEntries; }
+
+	/**
+	 * Collects the indexes of all entries that might contain the given literal (ignoring case).
+	 * Returns false if the literal is too short to narrow down the candidates.
+	 */
+	bool FindCandidates(QStringView literal, size_t entryCount, std::vector<uint32_t>& candidates) const;
+
+	[[nodiscard]] static inline char16_t FoldCase(char16_t c)
+	{
+		if (c < 0x80) return (c >= 'A' && c <= 'Z') ? static_cast<char16_t>(c | 0x20) : c;
+		return QChar(c).toLower().unicode();
+	}
+
+	[[nodiscard]] static inline uint64_t MakeTrigram(const QChar* text)
+	{
+		return static_cast<uint64_t>(FoldCase(text[0].unicode())) << 32 | static_cast<uint64_t>(FoldCase(text[1].unicode())) << 16 | FoldCase(text[2].unicode());
+	}
+};
@@ -0,0 +1,98 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ZoneMap.h"
+#include "TrigramIndex.h"
+#include "Profiler.hpp"
+#include <QtConcurrent>
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+	inline uint64_t HashTrigram(uint64_t trigram)
+	{
+		return trigram * 0x9E3779B97F4A7C15ull;
+	}
+}
+
+void ZoneMap::AddToBloom(std::vector<uint64_t>& bloom, uint64_t trigram)
+{
+	// Two probes taken from different bits of a single multiplicative hash
+	const uint64_t hash = HashTrigram(trigram);
+	const uint64_t first = hash >> (64 - BLOOM_BITS_LOG2), second = (hash >> 20) & ((uint64_t(1) << BLOOM_BITS_LOG2) - 1);
+	bloom[first >> 6] |= uint64_t(1) << (first & 63);
+	bloom[second >> 6] |= uint64_t(1) << (second & 63);
+}
+
+void ZoneMap::Build(const std::vector<LogEntry>& entries, const std::vector<int64_t>& timeStamps, const std::vector<uint16_t>& levelIds)
+{
+	BlockProfiler profiler("Build zone map");
+	chunks.clear();
+	chunks.resize((entries.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+	std::vector<size_t> chunkIndices(chunks.size());
+	std::iota(chunkIndices.begin(), chunkIndices.end(), 0);
+	QtConcurrent::blockingMap(chunkIndices, [&](size_t chunkIndex) {
+		Chunk& chunk = chunks[chunkIndex];
+		chunk.trigramBloom.assign(BLOOM_WORDS, 0);
+		const size_t end = std::min(entries.size(), (chunkIndex + 1) * CHUNK_SIZE);
+		for (size_t i = chunkIndex * CHUNK_SIZE; i < end; i++)
+		{
+			chunk.minTimeStamp = std::min(chunk.minTimeStamp, timeStamps[i]);
+			chunk.maxTimeStamp = std::max(chunk.maxTimeStamp, timeStamps[i]);
+			chunk.levelMask |= GetLevelBit(levelIds[i]);
+
+			const QString& message = entries[i].components[LogComponent::MESSAGE];
+			if (message.length() < TrigramIndex::TRIGRAM_LENGTH) continue;
+			// Rolling trigram, every character only gets folded once
+			const QChar* text = message.constData();
+			uint64_t trigram = static_cast<uint64_t>(TrigramIndex::FoldCase(text[0].unicode())) << 16 | TrigramIndex::FoldCase(text[1].unicode());
+			for (qsizetype pos = 2; pos < message.length(); pos++)
+			{
+				trigram = (trigram << 16 | TrigramIndex::FoldCase(text[pos].unicode())) & 0xFFFFFFFFFFFFull;
+				AddToBloom(chunk.trigramBloom, trigram);
+			}
+		}
+	});
+}
+
+std::vector<uint64_t> ZoneMap::GetTrigrams(const QStringList& literals)
+{
+	std::vector<uint64_t> trigrams;
+	for (const QString& literal : literals)
+	{
+		for (qsizetype pos = 0; pos + TrigramIndex::TRIGRAM_LENGTH <= literal.length(); pos++)
+		{
+			trigrams.push_back(TrigramIndex::MakeTrigram(literal.constData() + pos));
+		}
+	}
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+	return trigrams;
+}
+
+bool ZoneMap::MayContainTrigrams(size_t chunk, const std::vector<uint64_t>& trigrams) const
+{
+	const std::vector<uint64_t>& bloom = chunks[chunk].trigramBloom;
+	for (const uint64_t trigram : trigrams)
+	{
+		const uint64_t hash = HashTrigram(trigram);
+		const uint64_t first = hash >> (64 - BLOOM_BITS_LOG2), second = (hash >> 20) & ((uint64_t(1) << BLOOM_BITS_LOG2) - 1);
+		if (!((bloom[first >> 6] >> (first & 63)) & 1) || !((bloom[second >> 6] >> (second & 63)) & 1)) return false;
+	}
+	return true;
+}
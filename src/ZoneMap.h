@@ -0,0 +1,74 @@
+/*
+ *   Copyright (C) 2023 GeorgH93
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "LogEntry.h"
+#include <QStringList>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Summaries of fixed size chunks of a log, letting filters and searches skip chunks that can't contain a match.
+ * Every chunk keeps its time range, the levels occurring in it and a bloom filter of the case folded
+ * message trigrams, which answers whether any message of the chunk might contain a literal.
+ */
+class ZoneMap final
+{
+public:
+	static constexpr uint32_t CHUNK_SIZE = 65536;
+
+	struct Chunk
+	{
+		int64_t minTimeStamp = INT64_MAX, maxTimeStamp = INT64_MIN;
+		// Bit per level id, ids that don't fit share the last bit
+		uint64_t levelMask = 0;
+		std::vector<uint64_t> trigramBloom;
+	};
+
+	void Build(const std::vector<LogEntry>& entries, const std::vector<int64_t>& timeStamps, const std::vector<uint16_t>& levelIds);
+
+	[[nodiscard]] size_t GetChunkCount() const { return chunks.size(); }
+
+	[[nodiscard]] const Chunk& GetChunk(size_t chunk) const { return chunks[chunk]; }
+
+	[[nodiscard]] static uint64_t GetLevelBit(uint16_t levelId) { return uint64_t(1) << std::min<uint16_t>(levelId, 63); }
+
+	// Hashes of the case folded trigrams of the literals, literals shorter than a trigram are ignored
+	[[nodiscard]] static std::vector<uint64_t> GetTrigrams(const QStringList& literals);
+
+	// Whether a message in the chunk might contain all given trigrams, false positives are possible
+	[[nodiscard]] bool MayContainTrigrams(size_t chunk, const std::vector<uint64_t>& trigrams) const;
+
+	// Whether a timestamp of the chunk might lie in [from, to)
+	[[nodiscard]] bool MayContainTime(size_t chunk, int64_t from, int64_t to) const
+	{
+		return chunks[chunk].maxTimeStamp >= from && chunks[chunk].minTimeStamp < to;
+	}
+
+	[[nodiscard]] bool MayContainLevels(size_t chunk, uint64_t levelMask) const { return (chunks[chunk].levelMask & levelMask) != 0; }
+
+private:
+	// 64KB per chunk, keeping false positives at a few percent for typical messages
+	static constexpr uint32_t BLOOM_BITS_LOG2 = 19;
+	static constexpr uint32_t BLOOM_WORDS = (uint32_t(1) << BLOOM_BITS_LOG2) / 64;
+
+	static void AddToBloom(std::vector<uint64_t>& bloom, uint64_t trigram);
+
+	std::vector<Chunk> chunks;
+};
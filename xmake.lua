@@ -20,4 +20,4 @@ target("QLogViewer")
 	add_packages("yaml-cpp")
 	
 	add_rules("qt.application")
-	add_frameworks("QtWidgets")
+	add_frameworks("QtWidgets", "QtConcurrent")